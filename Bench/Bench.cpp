@@ -0,0 +1,663 @@
+// Bench.cpp : Headless benchmarks of the engine for the standard piece set.
+//
+// Usage:
+//   bench smp [-depth <n>] [-threads <n>] [-hash <MB>]
+//     Time to reach a search depth on a fixed set of positions, with 1, 2, 4... up to
+//     the given amount of threads (all cores by default), and the speedup over 1 thread.
+//   bench see [-iterations <n>]
+//     Static exchange evaluations per second, over the captures of the positions.
+//   bench nnue [-iterations <n>] [-weights <file>]
+//     Network evaluations, incremental accumulator updates and full refreshes per second,
+//     SIMD and scalar, over the positions and the positions after each of their moves.
+//     Uses random weights unless a weights file is given, and checks the SIMD kernels and
+//     incremental updates against the scalar reference first.
+//   bench moves [-depth <n>]
+//     Move list memory per ply of the tree below the positions, walked with the search's
+//     move picker, against the legal move tables it replaces.
+//   bench pieceset [-depth <n>]
+//     Move generation speed (leaves of the legal move tree per second) with the standard
+//     pieces resolved at compile time and through the PieceDef virtual functions.
+//   bench rays [-iterations <n>]
+//     Obstruction checks per second of the sliding pieces of the positions, walking the
+//     moveset path square by square and with the precomputed between masks.
+//   bench byte88 [-iterations <n>]
+//     Byte88 operators and bitboard extraction, SIMD against scalar loops over the bytes,
+//     on the boards of the positions. Checks that both give the same results first.
+//   bench verdict [-depth <n>]
+//     Time to find whether the game goes on, is checkmate or stalemate at every node of the
+//     tree below the positions, counting every legal move and stopping at the first one.
+//   bench magics [-print]
+//     Time to build the sliding attack tables of the standard pieces with the magics of
+//     StandardMagics.h and by searching for them. -print writes the magics the search finds
+//     in the layout of StandardMagics.h, to paste in it when the movesets change.
+//
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "Position.h"
+#include "StandardPieces.h"
+#include "Fen.h"
+#include "SmpSearch.h"
+#include "See.h"
+#include "Nnue.h"
+#include "MovePicker.h"
+
+// Positions searched by the benchmarks
+static const char* BenchPositions[] =
+{
+	"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+	"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+	"r1bq1rk1/pp2bppp/2n1pn2/2pp4/3P4/2PBPN2/PP1N1PPP/R2QK2R w KQ - 0 8",
+	"r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+	"2r2rk1/pp2qppp/2n1pn2/3p4/3P4/P1NBPN2/1P3PPP/2RQ1RK1 b - - 0 14",
+	"8/2k5/3p4/p2P1p2/P2P1P2/8/3K4/8 w - - 0 1",
+	"8/8/2p5/1pP5/1P1k4/8/3K1N2/6n1 w - - 0 1",
+};
+static const int NumBenchPositions = sizeof(BenchPositions) / sizeof(BenchPositions[0]);
+
+// Seconds since an arbitrary point
+double now()
+{
+	using namespace std::chrono;
+	return duration<double>(steady_clock::now().time_since_epoch()).count();
+}
+
+// Load the benchmark positions
+std::vector<Position> loadPositions(std::vector<PieceDef*> pieces)
+{
+	std::vector<Position> positions;
+	for (int i = 0; i < NumBenchPositions; i++)
+	{
+		BoardState board;
+		byte team;
+		if (loadFen(BenchPositions[i], board, team)) { positions.push_back(Position(pieces, board, team)); }
+		else { printf("bad FEN: %s\n", BenchPositions[i]); }
+	}
+	return positions;
+}
+
+// Time to depth of the Lazy SMP search for every thread count from 1 to maxThreads
+// (powers of 2, and maxThreads itself). The table is cleared before each position.
+void benchSmp(std::vector<PieceDef*> pieces, int depth, int maxThreads, int hashMB)
+{
+	std::vector<Position> positions = loadPositions(pieces);
+	TranspositionTable tt(hashMB);
+	printf("%d positions, depth %d, %zu MB hash\n", (int)positions.size(), depth, tt.size() >> 20);
+	printf("threads      time       nodes      nodes/s  speedup\n");
+
+	std::vector<int> counts;
+	for (int n = 1; n < maxThreads; n *= 2) { counts.push_back(n); }
+	counts.push_back(maxThreads);
+
+	double baseTime = 0;
+	for (int threads : counts)
+	{
+		SmpSearch search(&tt, threads);
+		UINT64 nodes = 0;
+		double time = 0;
+		for (auto& pos : positions)
+		{
+			tt.clear();
+			double t = now();
+			search.think(pos, 1LL << 40, depth);
+			time += now() - t;
+			nodes += search.info.nodes;
+		}
+		if (threads == 1) { baseTime = time; }
+		printf("%7d  %7.3fs  %10llu  %11.0f  %6.2fx\n", threads, time, nodes, time > 0 ? nodes / time : 0,
+			time > 0 ? baseTime / time : 0);
+	}
+}
+
+// Static exchange evaluations per second over every capture of the positions, each
+// evaluated the given amount of times
+void benchSee(std::vector<PieceDef*> pieces, int iterations)
+{
+	std::vector<Position> positions = loadPositions(pieces);
+	std::vector<std::pair<Position*, Move>> captures;
+	for (auto& pos : positions)
+	{
+		MoveList moves;
+		pos.generateLegalMoves(pos.currTeam, moves, MovesNoisy);
+		for (int i = 0; i < moves.size; i++)
+		{
+			if (moves[i].flags() & MoveCapture) { captures.push_back(std::make_pair(&pos, moves[i])); }
+		}
+	}
+	printf("%d captures in %d positions, %d iterations\n", (int)captures.size(), (int)positions.size(), iterations);
+
+	long long sum = 0; // Keeps the evaluations from being optimized out
+	double t = now();
+	for (int n = 0; n < iterations; n++)
+	{
+		for (auto& c : captures) { sum += see(*c.first, c.second); }
+	}
+	t = now() - t;
+	double count = (double)captures.size() * iterations;
+	printf("%.0f evaluations  %.3fs  %.0f evaluations/s  (checksum %lld)\n", count, t, t > 0 ? count / t : 0, sum);
+}
+
+// Run a benchmark body the given amount of times and print its rate. The body runs once
+// untimed first, to warm up the caches.
+template<typename F> void rate(const char* name, double count, int iterations, F body)
+{
+	body();
+	double t = now();
+	for (int n = 0; n < iterations; n++) { body(); }
+	t = now() - t;
+	count *= iterations;
+	printf("%-22s %11.0f  %7.3fs  %11.0f/s\n", name, count, t, t > 0 ? count / t : 0);
+}
+
+// Throughput of the network over the positions and every position one move after them,
+// each evaluated the given amount of times
+void benchNnue(std::vector<PieceDef*> pieces, int iterations, const char* weights)
+{
+	Nnue& net = nnue();
+	if (weights != NULL)
+	{
+		if (!net.load(weights))
+		{
+			printf("can't load %s\n", weights);
+			return;
+		}
+	}
+	else { net.randomize(1); }
+
+	// The positions, and each of their children with the position it comes from
+	std::vector<Position> positions = loadPositions(pieces);
+	std::vector<Position> children;
+	std::vector<int> parents;
+	for (size_t i = 0; i < positions.size(); i++)
+	{
+		MoveList moves;
+		positions[i].generateLegalMoves(positions[i].currTeam, moves);
+		for (int j = 0; j < moves.size; j++)
+		{
+			children.push_back(positions[i]);
+			children.back().makeMove(moves[j].start(), moves[j].end());
+			parents.push_back((int)i);
+		}
+	}
+	std::vector<NnueAccumulator> rootAcc(positions.size());
+	std::vector<NnueAccumulator> acc(children.size());
+	for (size_t i = 0; i < positions.size(); i++) { net.refresh(positions[i].board, rootAcc[i]); }
+
+	// Incremental updates and SIMD kernels must match the scalar reference
+	int mismatches = 0;
+	for (size_t i = 0; i < children.size(); i++)
+	{
+		NnueAccumulator ref;
+		net.refreshScalar(children[i].board, ref);
+		net.update(rootAcc[parents[i]], acc[i], positions[parents[i]].board, children[i].board);
+		if (memcmp(&ref, &acc[i], sizeof(ref)) != 0 ||
+			net.evaluate(acc[i], children[i].currTeam) != net.evaluateScalar(ref, children[i].currTeam)) { mismatches++; }
+	}
+#if defined(NNUE_AVX2)
+	const char* kernels = "AVX2";
+#elif defined(NNUE_SSE2)
+	const char* kernels = "SSE2";
+#else
+	const char* kernels = "scalar";
+#endif
+	printf("%s network, %s kernels, %d positions, %d children, %d iterations\n", weights != NULL ? weights : "random",
+		kernels, (int)positions.size(), (int)children.size(), iterations);
+	printf("kernels %s the scalar reference (%d mismatches)\n", mismatches == 0 ? "match" : "DON'T MATCH", mismatches);
+
+	long long sum = 0; // Keeps the evaluations from being optimized out
+	double n = (double)children.size();
+	rate("evaluate", n, iterations, [&]()
+	{
+		for (size_t i = 0; i < children.size(); i++) { sum += net.evaluate(acc[i], children[i].currTeam); }
+	});
+	rate("evaluate (scalar)", n, iterations, [&]()
+	{
+		for (size_t i = 0; i < children.size(); i++) { sum += net.evaluateScalar(acc[i], children[i].currTeam); }
+	});
+	rate("update", n, iterations, [&]()
+	{
+		for (size_t i = 0; i < children.size(); i++)
+		{
+			net.update(rootAcc[parents[i]], acc[i], positions[parents[i]].board, children[i].board);
+			sum += acc[i].values[0][i % NNUE_HIDDEN];
+		}
+	});
+	rate("refresh", n, iterations, [&]()
+	{
+		for (size_t i = 0; i < children.size(); i++)
+		{
+			net.refresh(children[i].board, acc[i]);
+			sum += acc[i].values[0][i % NNUE_HIDDEN];
+		}
+	});
+	rate("refresh (scalar)", n, iterations, [&]()
+	{
+		for (size_t i = 0; i < children.size(); i++)
+		{
+			net.refreshScalar(children[i].board, acc[i]);
+			sum += acc[i].values[0][i % NNUE_HIDDEN];
+		}
+	});
+	rate("update + evaluate", n, iterations, [&]()
+	{
+		for (size_t i = 0; i < children.size(); i++)
+		{
+			net.update(rootAcc[parents[i]], acc[i], positions[parents[i]].board, children[i].board);
+			sum += net.evaluate(acc[i], children[i].currTeam);
+		}
+	});
+	printf("(checksum %lld)\n", sum);
+}
+
+// Walk the tree below a position to a depth with the search's move picker, and count the leaves
+UINT64 walk(Position& pos, int depth)
+{
+	if (depth == 0) { return 1; }
+	UINT64 nodes = 0;
+	MovePicker picker(pos, SearchMove{ });
+	SearchMove move;
+	while (picker.next(move))
+	{
+		pos.makeMove(move.start(), move.end());
+		if (move.promotion != 0) { pos.promote(move.end(), move.promotion); }
+		nodes += walk(pos, depth - 1);
+		pos.undoMove();
+	}
+	return nodes;
+}
+
+// Memory of the move lists per ply of the trees below the positions. Before moves were
+// packed in 16 bits, moves took 3 bytes, lists were fixed arrays of MAX_MOVES of them and
+// the picker kept fixed arrays of MAX_MOVES moves and scores, on the stack at every ply.
+// The game kept the legal moves as a table of 64 Byte88.
+void benchMoves(std::vector<PieceDef*> pieces, int depth)
+{
+	std::vector<Position> positions = loadPositions(pieces);
+	MoveArena& arena = moveArena();
+	printf("%d positions, depth %d, %zu bytes per move (3 before), legal move table of the game %d bytes before\n",
+		(int)positions.size(), depth, sizeof(Move), 64 * 64);
+	printf("position       leaves     time  peak bytes  bytes/ply\n");
+	size_t before = MAX_MOVES * 3 + sizeof(int) + MAX_MOVES * (sizeof(SearchMove) + sizeof(int));
+	size_t worst = 0;
+	for (size_t i = 0; i < positions.size(); i++)
+	{
+		arena.peak = 0;
+		double t = now();
+		UINT64 leaves = walk(positions[i], depth);
+		t = now() - t;
+		size_t perPly = arena.peak / depth;
+		if (perPly > worst) { worst = perPly; }
+		printf("%8d  %11llu  %6.3fs  %10zu  %9zu\n", (int)i, leaves, t, arena.peak, perPly);
+	}
+	printf("at most %zu bytes per ply, %zu before (%.0fx less)\n", worst, before, worst > 0 ? (double)before / worst : 0);
+}
+
+// Count the leaves of the legal move tree to a depth, making every move. Promoting moves
+// are counted once, without promoting.
+UINT64 countLeaves(Position& pos, int depth)
+{
+	MoveList moves;
+	pos.generateLegalMoves(pos.currTeam, moves);
+	if (depth <= 1) { return moves.size; }
+	UINT64 nodes = 0;
+	for (int i = 0; i < moves.size; i++)
+	{
+		pos.makeMove(moves[i].start(), moves[i].end());
+		nodes += countLeaves(pos, depth - 1);
+		pos.undoMove();
+	}
+	return nodes;
+}
+
+// Leaves per second of the legal move tree below the positions, with the pieces dispatched
+// by each PieceSetKind
+void benchPieceSet(std::vector<PieceDef*> pieces, int depth)
+{
+	std::vector<Position> positions = loadPositions(pieces);
+	printf("%d positions, depth %d\n", (int)positions.size(), depth);
+	printf("piece set       leaves     time     leaves/s  speedup\n");
+	const char* names[] = { "dynamic", "standard" };
+	double baseTime = 0;
+	UINT64 baseNodes = 0;
+	for (int kind = PieceSetDynamic; kind <= PieceSetStandard; kind++)
+	{
+		UINT64 nodes = 0;
+		double time = 0;
+		for (auto& pos : positions)
+		{
+			if (!pos.usePieceSet(kind)) { printf("the pieces don't match the %s piece set\n", names[kind]); }
+			double t = now();
+			nodes += countLeaves(pos, depth);
+			time += now() - t;
+		}
+		if (kind == PieceSetDynamic)
+		{
+			baseTime = time;
+			baseNodes = nodes;
+		}
+		printf("%-9s  %11llu  %6.3fs  %11.0f  %6.2fx%s\n", names[kind], nodes, time, time > 0 ? nodes / time : 0,
+			time > 0 ? baseTime / time : 0, nodes != baseNodes ? "  COUNTS DON'T MATCH" : "");
+	}
+}
+
+// Check if the path of a move is clear by walking the moveset table back to the start square,
+// one board lookup per square, as UnitMovePiece did before the between masks
+bool walkPathClear(const UnitMoveset& m, int from, int to, const BoardState& board)
+{
+	int i = ((to >> 3) - (from >> 3) + 8) << 4 | ((to & 7) - (from & 7) + 8);
+	while (m.moveset[i] != 0x88)
+	{
+		i = m.moveset[i];
+		if (board[from + ((i >> 4) - 8) * 8 + (i & 0xF) - 8] != 0) { return false; }
+	}
+	return true;
+}
+
+// Obstruction checks per second for every square the sliding pieces of the positions reach
+// on an empty board, each checked the given amount of times
+void benchRays(std::vector<PieceDef*> pieces, int iterations)
+{
+	std::vector<Position> positions = loadPositions(pieces);
+	struct Check
+	{
+		const BoardState* board;
+		const UnitMoveset* moveset;
+		int from, to;
+	};
+	std::vector<Check> checks;
+	for (auto& pos : positions)
+	{
+		UINT64 occ = pos.board.occupied;
+		while (occ)
+		{
+			int from = popLsb(occ);
+			UnitMovePiece* def = dynamic_cast<UnitMovePiece*>(pos.pieceDefs[pos.board[from] & PIECE_ID]);
+			if (def == NULL || def->canJump) { continue; }
+			UINT64 reach = def->getMoveset().reach[from];
+			while (reach) { checks.push_back(Check{ &pos.board, &def->getMoveset(), from, popLsb(reach) }); }
+		}
+	}
+	// Both must agree
+	int mismatches = 0;
+	for (auto& c : checks)
+	{
+		bool clear = (c.moveset->between[64 * c.from + c.to] & c.board->occupied) == 0;
+		if (clear != walkPathClear(*c.moveset, c.from, c.to, *c.board)) { mismatches++; }
+	}
+	printf("%d checks in %d positions, %d iterations\n", (int)checks.size(), (int)positions.size(), iterations);
+	printf("between masks %s the path walk (%d mismatches)\n", mismatches == 0 ? "match" : "DON'T MATCH", mismatches);
+
+	long long sum = 0; // Keeps the checks from being optimized out
+	double n = (double)checks.size();
+	rate("path walk", n, iterations, [&]()
+	{
+		for (auto& c : checks) { sum += walkPathClear(*c.moveset, c.from, c.to, *c.board); }
+	});
+	rate("between mask", n, iterations, [&]()
+	{
+		for (auto& c : checks) { sum += (c.moveset->between[64 * c.from + c.to] & c.board->occupied) == 0; }
+	});
+	printf("(checksum %lld)\n", sum);
+}
+
+// Scalar references of the Byte88 operations, a byte at a time
+void scalarAnd(Byte88& a, byte b) { for (int i = 0; i < 64; i++) { a.data[i] &= b; } }
+void scalarShr(Byte88& a, byte b) { for (int i = 0; i < 64; i++) { a.data[i] >>= b; } }
+void scalarXor(Byte88& a, const Byte88& b) { for (int i = 0; i < 64; i++) { a.data[i] ^= b.data[i]; } }
+void scalarAdd(Byte88& a, const Byte88& b) { for (int i = 0; i < 64; i++) { a.data[i] += b.data[i]; } }
+UINT64 scalarToBitboard(const Byte88& a, byte mask, byte value)
+{
+	UINT64 bb = 0;
+	for (int i = 0; i < 64; i++)
+	{
+		if ((a.data[i] & mask) == value) { bb |= SQUARE_BB(i); }
+	}
+	return bb;
+}
+
+// Byte88 operations per second over the boards of the positions, SIMD and scalar
+void benchByte88(std::vector<PieceDef*> pieces, int iterations)
+{
+	std::vector<Position> positions = loadPositions(pieces);
+	std::vector<Byte88> boards;
+	for (auto& pos : positions) { boards.push_back(pos.board); }
+#if defined(BYTE88_AVX2)
+	const char* lanes = "AVX2";
+#elif defined(BYTE88_SSE2)
+	const char* lanes = "SSE2";
+#else
+	const char* lanes = "UINT64";
+#endif
+	// Both must agree, on the boards and with every shift
+	int mismatches = 0;
+	for (size_t i = 0; i < boards.size(); i++)
+	{
+		const Byte88& a = boards[i];
+		const Byte88& b = boards[(i + 1) % boards.size()];
+		for (int n = 0; n < 10; n++)
+		{
+			Byte88 r = a, sr = a, l = a, sl = a;
+			r >>= (byte)n;
+			for (int k = 0; k < 64; k++) { sr.data[k] = n < 8 ? a.data[k] >> n : 0; sl.data[k] = (byte)(n < 8 ? a.data[k] << n : 0); }
+			l <<= (byte)n;
+			mismatches += memcmp(&r, &sr, 64) != 0 || memcmp(&l, &sl, 64) != 0;
+		}
+		Byte88 x = a + b, sx = a;
+		scalarAdd(sx, b);
+		mismatches += memcmp(&x, &sx, 64) != 0;
+		x = a - b;
+		for (int k = 0; k < 64; k++) { sx.data[k] = a.data[k] - b.data[k]; }
+		mismatches += memcmp(&x, &sx, 64) != 0;
+		x = ~(a ^ b) & 0x3F;
+		for (int k = 0; k < 64; k++) { sx.data[k] = ~(a.data[k] ^ b.data[k]) & 0x3F; }
+		mismatches += memcmp(&x, &sx, 64) != 0;
+		for (int id = 0; id < 16; id++) { mismatches += a.findAll((byte)id) != scalarToBitboard(a, 0x0F, (byte)id); }
+	}
+	printf("%s lanes, %d boards, %d iterations\n", lanes, (int)boards.size(), iterations);
+	printf("operators %s the scalar loops (%d mismatches)\n", mismatches == 0 ? "match" : "DON'T MATCH", mismatches);
+
+	long long sum = 0; // Keeps the operations from being optimized out
+	double n = (double)boards.size();
+	Byte88 acc;
+	rate("&= byte", n, iterations, [&]() { for (auto& b : boards) { Byte88 c = b; c &= (byte)~PIECE_SPTEMP; acc ^= c; } });
+	rate("&= byte (scalar)", n, iterations, [&]() { for (auto& b : boards) { Byte88 c = b; scalarAnd(c, (byte)~PIECE_SPTEMP); scalarXor(acc, c); } });
+	rate("(x >> 1) & 0xf0", n, iterations, [&]() { for (auto& b : boards) { acc ^= (b >> 1) & 0xf0; } });
+	rate("(x >> 1) & 0xf0 (scalar)", n, iterations, [&]()
+	{
+		for (auto& b : boards)
+		{
+			Byte88 c = b;
+			scalarShr(c, 1);
+			scalarAnd(c, 0xf0);
+			scalarXor(acc, c);
+		}
+	});
+	rate("+=", n, iterations, [&]() { for (auto& b : boards) { acc += b; } });
+	rate("+= (scalar)", n, iterations, [&]() { for (auto& b : boards) { scalarAdd(acc, b); } });
+	rate("findAll", n * 6, iterations, [&]()
+	{
+		for (auto& b : boards)
+		{
+			for (int id = 1; id <= 6; id++) { sum += b.findAll((byte)id); }
+		}
+	});
+	rate("findAll (scalar)", n * 6, iterations, [&]()
+	{
+		for (auto& b : boards)
+		{
+			for (int id = 1; id <= 6; id++) { sum += scalarToBitboard(b, 0x0F, (byte)id); }
+		}
+	});
+	for (int i = 0; i < 64; i++) { sum += acc.data[i]; }
+	printf("(checksum %lld)\n", sum);
+}
+
+// Time of the game end verdicts of the game, at every node of the tree below a position
+struct VerdictTimes
+{
+	double full;	// Generating every legal move and scanning the critical pieces for checks
+	double early;	// Stopping at the first legal move, checks from the legality filter
+	UINT64 nodes;
+	UINT64 ended;	// Nodes with no legal move
+	UINT64 mismatches;
+};
+
+// Find the verdicts of every node of the tree below a position to a depth, both ways
+void verdicts(Position& pos, int depth, VerdictTimes& times)
+{
+	double t = now();
+	bool fullMoves, fullCheck;
+	{
+		MoveList moves;
+		fullMoves = pos.generateLegalMoves(pos.currTeam, moves) != 0;
+		fullCheck = pos.inCheck(pos.currTeam);
+	}
+	double t2 = now();
+	Legality legality = Legality();
+	pos.computeLegality(legality, pos.currTeam);
+	bool earlyCheck = legality.usable ? legality.checkers != 0 : pos.inCheck(pos.currTeam);
+	bool earlyMoves = pos.hasAnyLegalMove(pos.currTeam, legality);
+	double t3 = now();
+	times.full += t2 - t;
+	times.early += t3 - t2;
+	times.nodes++;
+	times.ended += !fullMoves;
+	times.mismatches += fullMoves != earlyMoves || fullCheck != earlyCheck;
+	if (depth == 0) { return; }
+	MoveList moves;
+	pos.generateLegalMoves(pos.currTeam, moves);
+	for (int i = 0; i < moves.size; i++)
+	{
+		pos.makeMove(moves[i].start(), moves[i].end());
+		verdicts(pos, depth - 1, times);
+		pos.undoMove();
+	}
+}
+
+// Game end verdicts per second over the tree below the positions, counting every legal move
+// as the game did after each move, and stopping at the first legal move
+void benchVerdict(std::vector<PieceDef*> pieces, int depth)
+{
+	std::vector<Position> positions = loadPositions(pieces);
+	VerdictTimes times = VerdictTimes{ };
+	for (auto& pos : positions) { verdicts(pos, depth, times); }
+	printf("%d positions, depth %d, %llu nodes, %llu without legal moves\n", (int)positions.size(), depth,
+		times.nodes, times.ended);
+	printf("verdicts %s (%llu mismatches)\n", times.mismatches == 0 ? "match" : "DON'T MATCH", times.mismatches);
+	printf("verdict          time    verdicts/s  speedup\n");
+	printf("all moves    %7.3fs  %12.0f  %6.2fx\n", times.full, times.full > 0 ? times.nodes / times.full : 0, 1.0);
+	printf("first move   %7.3fs  %12.0f  %6.2fx\n", times.early, times.early > 0 ? times.nodes / times.early : 0,
+		times.early > 0 ? times.full / times.early : 0);
+}
+
+// Print the magics of a piece in the layout of StandardMagics.h
+void printMagics(const char* name, const UnitMovePiece& piece)
+{
+	std::vector<SlidingMagic> magics = piece.magics();
+	printf("constexpr SlidingMagic %s[%d] =\n{\n", name, (int)magics.size());
+	for (size_t i = 0; i < magics.size(); i++)
+	{
+		printf("%s{ 0x%016llXULL, %d }%s", i % 3 == 0 ? "\t" : "", magics[i].magic, magics[i].shift,
+			i + 1 == magics.size() ? "\n" : i % 3 == 2 ? ",\n" : ", ");
+	}
+	printf("};\n\n");
+}
+
+// Time to build the sliding attack tables of the standard pieces with their known magics
+// and by searching for them (the same with PEXT, which needs no magics)
+void benchMagics(bool print)
+{
+	const char* names[3] = { "BishopMagics", "RookMagics", "QueenMagics" };
+	const UnitMoveset* movesets[3] = { &BishopMoveset, &RookMoveset, &QueenMoveset };
+	std::unique_ptr<UnitMovePiece> known[3], searched[3];
+	auto t0 = std::chrono::steady_clock::now();
+	for (int i = 0; i < 3; i++) { known[i].reset(new UnitMovePiece(2, false, false, BishopSprite)); }
+	known[0]->setMoveset(BishopMoveset, BishopMagics);
+	known[1]->setMoveset(RookMoveset, RookMagics);
+	known[2]->setMoveset(QueenMoveset, QueenMagics);
+	auto t1 = std::chrono::steady_clock::now();
+	for (int i = 0; i < 3; i++)
+	{
+		searched[i].reset(new UnitMovePiece(2, false, false, BishopSprite));
+		searched[i]->setMoveset(*movesets[i]);
+	}
+	auto t2 = std::chrono::steady_clock::now();
+	double knownTime = std::chrono::duration<double>(t1 - t0).count(), searchTime = std::chrono::duration<double>(t2 - t1).count();
+#ifdef SLIDING_USE_PEXT
+	printf("PEXT tables, no magics\n");
+#else
+	// The known magics must have been kept
+	int mismatches = 0;
+	const SlidingMagic* tables[3] = { BishopMagics, RookMagics, QueenMagics };
+	for (int i = 0; i < 3; i++)
+	{
+		std::vector<SlidingMagic> magics = known[i]->magics();
+		for (size_t j = 0; j < magics.size(); j++)
+		{
+			mismatches += magics[j].magic != tables[i][j].magic || magics[j].shift != tables[i][j].shift;
+		}
+	}
+	printf("known magics %s (%d not used)\n", mismatches == 0 ? "used" : "NOT ALL USED", mismatches);
+#endif
+	printf("magics         time  speedup\n");
+	printf("searched   %7.1fms  %6.2fx\n", searchTime * 1000, 1.0);
+	printf("known      %7.1fms  %6.2fx\n", knownTime * 1000, knownTime > 0 ? searchTime / knownTime : 0);
+	if (!print) { return; }
+	printf("\n");
+	for (int i = 0; i < 3; i++) { printMagics(names[i], *searched[i]); }
+}
+
+// Print the usage of the tool
+int usage()
+{
+	printf("usage: bench smp [-depth <n>] [-threads <n>] [-hash <MB>]\n");
+	printf("       bench see [-iterations <n>]\n");
+	printf("       bench nnue [-iterations <n>] [-weights <file>]\n");
+	printf("       bench moves [-depth <n>]\n");
+	printf("       bench pieceset [-depth <n>]\n");
+	printf("       bench rays [-iterations <n>]\n");
+	printf("       bench byte88 [-iterations <n>]\n");
+	printf("       bench verdict [-depth <n>]\n");
+	printf("       bench magics [-print]\n");
+	return 2;
+}
+
+int main(int argc, char** argv)
+{
+	StandardPieces pieces;
+	int depth = 0; // Default of each benchmark
+	int threads = (int)std::thread::hardware_concurrency();
+	int hashMB = 64;
+	int iterations = 0; // Default of each benchmark
+	const char* weights = NULL;
+	bool print = false;
+	if (argc < 2) { return usage(); }
+	for (int i = 2; i < argc; i++)
+	{
+		if (!strcmp(argv[i], "-depth") && i + 1 < argc) { depth = atoi(argv[++i]); }
+		else if (!strcmp(argv[i], "-threads") && i + 1 < argc) { threads = atoi(argv[++i]); }
+		else if (!strcmp(argv[i], "-hash") && i + 1 < argc) { hashMB = atoi(argv[++i]); }
+		else if (!strcmp(argv[i], "-iterations") && i + 1 < argc) { iterations = atoi(argv[++i]); }
+		else if (!strcmp(argv[i], "-weights") && i + 1 < argc) { weights = argv[++i]; }
+		else if (!strcmp(argv[i], "-print")) { print = true; }
+		else { return usage(); }
+	}
+	if (!strcmp(argv[1], "smp")) { benchSmp(pieces.list(), depth > 0 ? depth : 6, threads > 0 ? threads : 1, hashMB); }
+	else if (!strcmp(argv[1], "see")) { benchSee(pieces.list(), iterations > 0 ? iterations : 100000); }
+	else if (!strcmp(argv[1], "nnue")) { benchNnue(pieces.list(), iterations > 0 ? iterations : 1000, weights); }
+	else if (!strcmp(argv[1], "moves")) { benchMoves(pieces.list(), depth > 0 ? depth : 4); }
+	else if (!strcmp(argv[1], "pieceset")) { benchPieceSet(pieces.list(), depth > 0 ? depth : 4); }
+	else if (!strcmp(argv[1], "rays")) { benchRays(pieces.list(), iterations > 0 ? iterations : 100000); }
+	else if (!strcmp(argv[1], "byte88")) { benchByte88(pieces.list(), iterations > 0 ? iterations : 1000000); }
+	else if (!strcmp(argv[1], "verdict")) { benchVerdict(pieces.list(), depth > 0 ? depth : 3); }
+	else if (!strcmp(argv[1], "magics")) { benchMagics(print); }
+	else { return usage(); }
+	return 0;
+}
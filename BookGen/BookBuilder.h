@@ -0,0 +1,202 @@
+#pragma once
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <queue>
+#include <string>
+#include <vector>
+
+#include "Book.h"
+#include "Fen.h"
+
+// Builds an opening book from a corpus of games too large to fit in memory, by an external
+// sort: the moves of the games are collected in a buffer which, when full, is sorted and
+// written to a run file with the repeated moves merged. The sorted runs are then merged
+// into the book in a single pass, so the memory used is the size of the buffer.
+class BookBuilder
+{
+private:
+	// Move of a position while building, with wider counts than the book
+	struct Record
+	{
+		UINT64 key;		// Zobrist key of the position
+		UINT16 move;	// Packed move
+		UINT32 points;	// Points of the team playing the move: 2 per win, 1 per draw
+		UINT32 games;	// Games the move was played in
+
+		bool operator<(const Record& r) const
+		{
+			return key < r.key || (key == r.key && move < r.move);
+		}
+	};
+
+	Position& pos;				// Position the games are played on
+	std::string path;			// Path of the book, the runs are written next to it
+	size_t bufferSize;			// Most records of the buffer
+	std::vector<Record> buffer;	// Moves not yet written to a run
+	std::vector<std::string> runs;	// Paths of the run files
+
+	// Sort the buffer, merge the repeated moves and write it to a new run file
+	bool flush()
+	{
+		std::sort(buffer.begin(), buffer.end());
+		size_t n = 0;
+		for (size_t i = 0; i < buffer.size(); i++)
+		{
+			if (n > 0 && buffer[n - 1].key == buffer[i].key && buffer[n - 1].move == buffer[i].move)
+			{
+				buffer[n - 1].points += buffer[i].points;
+				buffer[n - 1].games += buffer[i].games;
+			}
+			else { buffer[n++] = buffer[i]; }
+		}
+		std::string run = path + ".run" + std::to_string(runs.size());
+		runsWritten++;
+		std::ofstream file(run, std::ios::binary);
+		runs.push_back(run);
+		bool ok = (bool)file.write((const char*)buffer.data(), (std::streamsize)(n * sizeof(Record)));
+		buffer.clear();
+		return ok;
+	}
+
+	// Write the moves of a position to the book. The weights are scaled down to fit in
+	// 16 bits if needed, keeping their proportions.
+	void writePosition(std::ofstream& file, const std::vector<Record>& moves, UINT32 minGames, UINT64& entries)
+	{
+		UINT64 most = 0;
+		for (const Record& r : moves) { most = std::max(most, (UINT64)r.points); }
+		for (const Record& r : moves)
+		{
+			if (r.games < minGames) { continue; }
+			UINT64 weight = r.points;
+			if (most > 0xFFFF) { weight = weight == 0 ? 0 : std::max(weight * 0xFFFF / most, (UINT64)1); }
+			BookEntry e = BookEntry{ r.key, r.move, (UINT16)weight, r.games };
+			file.write((const char*)&e, sizeof(e));
+			entries++;
+		}
+	}
+
+public:
+	int maxPlies;	// Moves of a game read into the book
+	UINT64 games;	// Games read
+	UINT64 moves;	// Moves read
+	UINT64 errors;	// Games with a move which couldn't be read, read up to it
+	int runsWritten;	// Run files written
+
+	// Create builder of a book file, buffering at most bufferMB MB of moves. At most
+	// MAX_PLY moves of each game are read.
+	BookBuilder(Position& pos, const std::string& path, size_t bufferMB, int maxPlies) : pos(pos), path(path),
+		bufferSize(std::max(bufferMB * 1024 * 1024 / sizeof(Record), (size_t)1)), maxPlies(std::min(maxPlies, MAX_PLY)),
+		games(0), moves(0), errors(0), runsWritten(0)
+	{ }
+
+	// Read a game from the starting position. Games are lines of moves in coordinate
+	// notation (ex. e2e4, e7e8q for promotions), move numbers (ex. "1.") are skipped and
+	// a result (1-0, 0-1, 1/2-1/2) sets the points of the moves. Empty lines, comments (#)
+	// and PGN tags ([) are skipped. Returns false if a write to a run file fails.
+	bool addGame(const std::string& line, const BoardState& start, const char* letters = STANDARD_PIECE_LETTERS)
+	{
+		size_t i = line.find_first_not_of(" \t\r");
+		if (i == std::string::npos || line[i] == '#' || line[i] == '[') { return true; }
+		pos.setBoard(start, 1);
+		Record played[MAX_PLY];
+		bool mover[MAX_PLY];
+		int plies = 0, winner = -1; // Team which won, -1 if none
+		bool bad = false;
+		Legality legality;
+		while (i < line.size())
+		{
+			size_t end = line.find_first_of(" \t\r", i);
+			if (end == std::string::npos) { end = line.size(); }
+			std::string token = line.substr(i, end - i);
+			i = line.find_first_not_of(" \t\r", end);
+			if (i == std::string::npos) { i = line.size(); }
+			if (token == "1-0" || token == "0-1") { winner = token == "1-0"; }
+			// Skip move numbers, and the moves past the plies of the book
+			token = token.substr(token.rfind('.') == std::string::npos ? 0 : token.rfind('.') + 1);
+			if (token.empty() || token.find('-') != std::string::npos || token == "*" || bad || plies >= maxPlies) { continue; }
+			// Find the legal move of the token
+			int from = token.size() >= 4 ? parseSquare(token.c_str()) : -1;
+			int to = token.size() >= 4 ? parseSquare(token.c_str() + 2) : -1;
+			const char* id = token.size() == 5 ? strchr(letters, tolower(token[4])) : NULL;
+			SearchMove m = SearchMove{ (byte)from, (byte)to, (byte)(id != NULL ? id - letters + 1 : 0), 0 };
+			Move legal;
+			pos.computeLegality(legality, pos.currTeam);
+			if (from < 0 || to < 0 || token.size() > 5 || (token.size() == 5 && id == NULL) ||
+				!pos.findLegalMove(pos.currTeam, from, to, legal, legality) ||
+				((legal.flags() & MovePromotion) != 0) != (m.promotion != 0) ||
+				(m.promotion != 0 && !pos.canPromote(m.start(), m.promotion)))
+			{
+				bad = true;
+				continue;
+			}
+			played[plies] = Record{ pos.hashKey(), (UINT16)m.pack(), 0, 1 };
+			mover[plies++] = pos.currTeam != 0;
+			if (pos.makeMove(m.start(), m.end())) { pos.promote(m.end(), m.promotion); }
+		}
+		games++;
+		errors += bad;
+		moves += plies;
+		for (int p = 0; p < plies; p++)
+		{
+			played[p].points = winner < 0 ? 1 : (mover[p] == (winner != 0)) ? 2 : 0;
+			buffer.push_back(played[p]);
+			if (buffer.size() >= bufferSize && !flush()) { return false; }
+		}
+		return true;
+	}
+
+	// Merge the runs into the book file, leaving out the moves played in less than minGames
+	// games, and delete them. Returns false if a file couldn't be read or written.
+	bool finish(UINT32 minGames, UINT64& entries)
+	{
+		entries = 0;
+		if (!buffer.empty() && !flush()) { return false; }
+		std::ofstream file(path, std::ios::binary);
+		BookHeader header = BookHeader{ { 'C', 'C', 'B', 'K' }, BOOK_VERSION, 0 };
+		file.write((const char*)&header, sizeof(header));
+		// Merge the runs, taking the smallest record of their next ones
+		std::vector<std::ifstream> inputs;
+		for (auto& run : runs) { inputs.emplace_back(run, std::ios::binary); }
+		typedef std::pair<Record, size_t> Head;
+		auto later = [](const Head& a, const Head& b) { return b.first < a.first; };
+		std::priority_queue<Head, std::vector<Head>, decltype(later)> heads(later);
+		Record r;
+		for (size_t k = 0; k < inputs.size(); k++)
+		{
+			if (inputs[k].read((char*)&r, sizeof(r))) { heads.push(Head(r, k)); }
+		}
+		std::vector<Record> position; // Moves of the current position
+		while (!heads.empty())
+		{
+			Head h = heads.top();
+			heads.pop();
+			if (inputs[h.second].read((char*)&r, sizeof(r))) { heads.push(Head(r, h.second)); }
+			if (!position.empty() && position.back().key != h.first.key)
+			{
+				writePosition(file, position, minGames, entries);
+				position.clear();
+			}
+			if (!position.empty() && position.back().move == h.first.move)
+			{
+				position.back().points += h.first.points;
+				position.back().games += h.first.games;
+			}
+			else { position.push_back(h.first); }
+		}
+		writePosition(file, position, minGames, entries);
+		// The amount of entries is known now
+		header.count = entries;
+		file.seekp(0);
+		file.write((const char*)&header, sizeof(header));
+		bool ok = (bool)file;
+		for (size_t k = 0; k < runs.size(); k++)
+		{
+			ok = ok && !inputs[k].bad();
+			inputs[k].close();
+			std::remove(runs[k].c_str());
+		}
+		runs.clear();
+		return ok;
+	}
+};
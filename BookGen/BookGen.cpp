@@ -0,0 +1,136 @@
+// BookGen.cpp : Opening book builder. Reads the moves of a corpus of games and writes the
+// book the game maps at startup (see Book.h), whose AI then plays the first moves of the
+// games without searching.
+//
+// Usage:
+//   bookgen <games>... [-book <file>] [-plies <n>] [-min <n>] [-memory <MB>]
+//     Build a book from files of games, one game per line in coordinate notation (see
+//     BookBuilder::addGame), "-" reads the games from the standard input. The first -plies
+//     moves of each game (20 by default) are read, and the moves played in less than -min
+//     games are left out. The moves are sorted in runs of -memory MB (64 by default)
+//     written next to the book, so the corpus can be larger than the memory.
+//   bookgen -probe "<fen>" [-book <file>]
+//     Print the moves of a position in the book.
+//
+
+#define _CRT_SECURE_NO_WARNINGS
+#define NOMINMAX // std::min and std::max, not the macros of <Windows.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "Position.h"
+#include "StandardPieces.h"
+#include "Fen.h"
+#include "Book.h"
+#include "BookBuilder.h"
+
+// Print the moves of a FEN position in the book
+int probe(Position& pos, const char* fen, const char* path)
+{
+	BoardState board;
+	byte team;
+	if (!loadFen(fen, board, team))
+	{
+		printf("bad FEN: %s\n", fen);
+		return 2;
+	}
+	if (!book().open(path))
+	{
+		printf("can't open the book %s\n", path);
+		return 2;
+	}
+	pos.setBoard(board, team);
+	const BookEntry* first;
+	int cnt = book().find(pos.hashKey(), first);
+	if (cnt == 0)
+	{
+		printf("position not in the book\n");
+		return 1;
+	}
+	UINT64 total = 0;
+	for (int i = 0; i < cnt; i++) { total += first[i].weight; }
+	for (int i = 0; i < cnt; i++)
+	{
+		SearchMove m = SearchMove::unpack(first[i].move);
+		std::string name = squareName(m.from) + squareName(m.to);
+		if (m.promotion != 0) { name += STANDARD_PIECE_LETTERS[m.promotion - 1]; }
+		printf("%-6s weight %5u (%5.1f%%)  %u games\n", name.c_str(), first[i].weight,
+			total ? 100.0 * first[i].weight / total : 0.0, first[i].games);
+	}
+	return 0;
+}
+
+int usage()
+{
+	printf("usage: bookgen <games>... [-book <file>] [-plies <n>] [-min <n>] [-memory <MB>]\n");
+	printf("       bookgen -probe \"<fen>\" [-book <file>]\n");
+	return 2;
+}
+
+int main(int argc, char** argv)
+{
+	StandardPieces pieces;
+	Position pos = Position(pieces.list());
+	pos.usePieceSet(PieceSetStandard);
+	const char* path = BOOK_DEFAULT_FILE;
+	const char* fen = NULL;
+	int plies = 20;
+	UINT32 minGames = 1;
+	size_t memory = 64;
+	std::vector<const char*> inputs;
+	for (int i = 1; i < argc; i++)
+	{
+		if (!strcmp(argv[i], "-book") && i + 1 < argc) { path = argv[++i]; }
+		else if (!strcmp(argv[i], "-probe") && i + 1 < argc) { fen = argv[++i]; }
+		else if (!strcmp(argv[i], "-plies") && i + 1 < argc) { plies = atoi(argv[++i]); }
+		else if (!strcmp(argv[i], "-min") && i + 1 < argc) { minGames = (UINT32)atoi(argv[++i]); }
+		else if (!strcmp(argv[i], "-memory") && i + 1 < argc) { memory = (size_t)atoi(argv[++i]); }
+		else if (argv[i][0] != '-' || !strcmp(argv[i], "-")) { inputs.push_back(argv[i]); }
+		else { return usage(); }
+	}
+	if (fen != NULL) { return probe(pos, fen, path); }
+	if (inputs.empty()) { return usage(); }
+
+	auto t0 = std::chrono::steady_clock::now();
+	BookBuilder builder(pos, path, memory, plies);
+	BoardState start = StandardPieces::startingBoard();
+	for (const char* input : inputs)
+	{
+		std::ifstream file;
+		if (strcmp(input, "-") != 0)
+		{
+			file.open(input);
+			if (!file)
+			{
+				printf("can't open %s\n", input);
+				return 1;
+			}
+		}
+		std::istream& in = strcmp(input, "-") != 0 ? file : std::cin;
+		std::string line;
+		while (std::getline(in, line))
+		{
+			if (!builder.addGame(line, start))
+			{
+				printf("can't write the runs of %s\n", path);
+				return 1;
+			}
+		}
+	}
+	printf("%llu games, %llu moves, %llu games with a bad move\n", builder.games, builder.moves, builder.errors);
+	UINT64 entries;
+	if (!builder.finish(minGames, entries))
+	{
+		printf("can't write %s\n", path);
+		return 1;
+	}
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+	printf("%s: %llu moves of positions from %d run(s), %.2fs\n", path, entries, builder.runsWritten, seconds);
+	return 0;
+}
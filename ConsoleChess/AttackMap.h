@@ -0,0 +1,116 @@
+#pragma once
+#include "Platform.h"
+#include <cassert>
+#include "BoardState.h"
+#include "PieceDef.h"
+#include "PieceSet.h"
+#include "Bitboard.h"
+
+// Define VERIFY_ATTACK_MAPS to check every incremental update against a full
+// recomputation. Enabled by default in debug builds.
+#if defined(_DEBUG) && !defined(VERIFY_ATTACK_MAPS)
+#define VERIFY_ATTACK_MAPS
+#endif
+
+// Per-team attack counts of every square, kept up to date incrementally.
+// Relies on the attack set of a piece only depending on the occupancy of the
+// squares inside it (see PieceDef::attacks), so a board change only requires
+// recomputing the pieces that attacked a changed square. The piece set policy
+// (see PieceSet.h) gives the attacks of the pieces.
+struct AttackMap
+{
+	UINT64 attacksFrom[64];	// Squares attacked by the piece on each square
+	byte owner[64];			// Board byte of the piece each attack set was computed for
+	UINT64 sources;			// Squares which have an attack set
+	byte count[2][64];		// Amount of pieces of each team attacking each square
+
+	// Create empty attack map.
+	AttackMap() : attacksFrom{ }, owner{ }, sources(0), count{ } {};
+
+	// Recompute the attack map from scratch.
+	template<typename Set = DynamicPieceSet>
+	void compute(const BoardState& board, PieceDef** defs)
+	{
+		std::fill_n(attacksFrom, 64, 0ULL);
+		std::fill_n(owner, 64, 0);
+		std::fill_n(&count[0][0], 128, 0);
+		sources = 0;
+		UINT64 pieces = board.occupied;
+		while (pieces) { add<Set>(popLsb(pieces), board, defs); }
+	}
+
+	// Update the attack map after the pieces on the changed squares were modified.
+	template<typename Set = DynamicPieceSet>
+	void update(const BoardState& board, PieceDef** defs, UINT64 changed)
+	{
+		// Pieces on changed squares and pieces attacking them must be recomputed
+		UINT64 redo = changed;
+		UINT64 src = sources & ~changed;
+		while (src)
+		{
+			int i = popLsb(src);
+			if (attacksFrom[i] & changed) { redo |= SQUARE_BB(i); }
+		}
+		while (redo)
+		{
+			int i = popLsb(redo);
+			if ((sources & board.occupied & SQUARE_BB(i)) && ((owner[i] ^ board[i]) & PIECE_TEAM) == 0)
+			{	// Same team before and after, only count the squares which changed
+				UINT64 old = attacksFrom[i];
+				UINT64 att = Set::attacks(defs, board[i], IVec2(i & 7, i >> 3), board);
+				int team = (board[i] & PIECE_TEAM) >> 4;
+				UINT64 lost = old & ~att, gained = att & ~old;
+				while (lost) { count[team][popLsb(lost)]--; }
+				while (gained) { count[team][popLsb(gained)]++; }
+				attacksFrom[i] = att;
+				owner[i] = board[i];
+				continue;
+			}
+			remove(i);
+			if (board.occupied & SQUARE_BB(i)) { add<Set>(i, board, defs); }
+		}
+#ifdef VERIFY_ATTACK_MAPS
+		assert(verify(board, defs));
+#endif
+	}
+
+	// Check if a square is attacked by a team.
+	bool isAttacked(int pos, int team) const
+	{
+		return count[team][pos] != 0;
+	}
+
+	// Compare the attack map with a full recomputation. Returns true if they match.
+	bool verify(const BoardState& board, PieceDef** defs) const
+	{
+		AttackMap full = AttackMap();
+		full.compute(board, defs);
+		return memcmp(full.count, count, sizeof(count)) == 0 &&
+			memcmp(full.attacksFrom, attacksFrom, sizeof(attacksFrom)) == 0;
+	}
+
+private:
+	// Add the attacks of the piece on a square.
+	template<typename Set>
+	void add(int pos, const BoardState& board, PieceDef** defs)
+	{
+		UINT64 att = Set::attacks(defs, board[pos], IVec2(pos & 7, pos >> 3), board);
+		int team = (board[pos] & PIECE_TEAM) >> 4;
+		attacksFrom[pos] = att;
+		owner[pos] = board[pos];
+		sources |= SQUARE_BB(pos);
+		while (att) { count[team][popLsb(att)]++; }
+	}
+
+	// Remove the attacks of the piece on a square.
+	void remove(int pos)
+	{
+		if ((sources & SQUARE_BB(pos)) == 0) { return; }
+		UINT64 att = attacksFrom[pos];
+		int team = (owner[pos] & PIECE_TEAM) >> 4;
+		while (att) { count[team][popLsb(att)]--; }
+		attacksFrom[pos] = 0;
+		owner[pos] = 0;
+		sources &= ~SQUARE_BB(pos);
+	}
+};
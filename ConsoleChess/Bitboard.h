@@ -0,0 +1,78 @@
+#pragma once
+#include "Platform.h"
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// MSVC has 64 bit scan intrinsics on x64 and ARM64 only, and 64 bit popcount on x64 only.
+// 32 bit targets scan each half of the bitboard and count the bits with the portable
+// bit tricks.
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+#define BITBOARD_SCAN64
+#endif
+#if defined(_MSC_VER) && defined(_M_X64)
+#define BITBOARD_POPCNT64
+#endif
+
+// Bitboard helpers. A bitboard is a UINT64 where bit i (LSB first) stands for
+// the square of index i, the same layout used by the Byte88(UINT64, low, high) ctor.
+
+// Macro to get the bitboard of a single square index
+#define SQUARE_BB(i) (1ULL << (i))
+
+// Get the index of the least significant set bit. Undefined for an empty board.
+inline int bitScan(UINT64 bb)
+{
+#if defined(BITBOARD_SCAN64)
+	unsigned long i;
+	_BitScanForward64(&i, bb);
+	return (int)i;
+#elif defined(_MSC_VER)
+	unsigned long i;
+	if (_BitScanForward(&i, (unsigned long)bb)) { return (int)i; }
+	_BitScanForward(&i, (unsigned long)(bb >> 32));
+	return (int)i + 32;
+#else
+	return __builtin_ctzll(bb);
+#endif
+}
+
+// Get the index of the most significant set bit. Undefined for an empty board.
+inline int bitScanReverse(UINT64 bb)
+{
+#if defined(BITBOARD_SCAN64)
+	unsigned long i;
+	_BitScanReverse64(&i, bb);
+	return (int)i;
+#elif defined(_MSC_VER)
+	unsigned long i;
+	if (_BitScanReverse(&i, (unsigned long)(bb >> 32))) { return (int)i + 32; }
+	_BitScanReverse(&i, (unsigned long)bb);
+	return (int)i;
+#else
+	return 63 ^ __builtin_clzll(bb);
+#endif
+}
+
+// Count the amount of set bits in a bitboard.
+inline int popCount(UINT64 bb)
+{
+#if defined(BITBOARD_POPCNT64)
+	return (int)__popcnt64(bb);
+#elif defined(_MSC_VER)
+	bb = bb - ((bb >> 1) & 0x5555555555555555ULL);
+	bb = (bb & 0x3333333333333333ULL) + ((bb >> 2) & 0x3333333333333333ULL);
+	bb = (bb + (bb >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+	return (int)((bb * 0x0101010101010101ULL) >> 56);
+#else
+	return __builtin_popcountll(bb);
+#endif
+}
+
+// Clear the least significant set bit of a bitboard and return its index.
+inline int popLsb(UINT64& bb)
+{
+	int i = bitScan(bb);
+	bb &= bb - 1;
+	return i;
+}
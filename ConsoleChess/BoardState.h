@@ -1,8 +1,14 @@
 #pragma once
 #include <algorithm>
-#include <Windows.h>
+#include <cassert>
+#include <memory>
+#include <stdexcept>
+#include "Platform.h"
 #include "IVec2.h"
 #include "Byte88.h"
+#include "Bitboard.h"
+#include "Zobrist.h"
+#include "PieceTables.h"
 
 #define PIECE_ID      0b00001111	// Bitmask for a Piece's ID
 #define PIECE_TEAM    0b00010000	// Bitmask for a Piece's team
@@ -35,26 +41,165 @@ struct Piece
 	}
 };
 
-/// Byte88 subclass to represent chess board
+#define UNDO_MAX_WRITES 80	// Most square writes a move can make: flags cleared on every square, and the move itself
+#define UNDO_STACK_SIZE 256	// Most undo records kept, for the last moves of the game and the search line
+
+// Undo record of a move: every square write the move made, with the byte it replaced.
+// Written by BoardState::set while a move is made (see Position::makeMove), and undone by
+// writing the old bytes back in reverse order, which also restores the bitboards, hash
+// and scores.
+struct UndoRecord
+{
+	byte squares[UNDO_MAX_WRITES];	// Index of each written square, in order
+	byte old[UNDO_MAX_WRITES];		// Byte of the square before each write
+	int count;						// Amount of writes
+	UINT64 changed;					// Squares whose piece changed (not only its flags)
+	UINT64 key;						// Zobrist key of the position before the move (see Position::hashKey)
+	int halfmoveClock;				// Halfmove clock before the move
+	int reversiblePlies;			// Reversible plies before the move
+
+	// Get the byte a square had before the move
+	byte before(int sqr, byte now) const
+	{
+		for (int i = 0; i < count; i++)
+		{
+			if (squares[i] == sqr) { return old[i]; }
+		}
+		return now;
+	}
+};
+
+// Stack of undo records of a fixed capacity, allocated once. When it is full, a push drops
+// the oldest record, so only the last UNDO_STACK_SIZE moves can be undone.
+class UndoStack
+{
+	std::unique_ptr<UndoRecord[]> records;	// Records in a ring, the top one before top
+	int top;		// Index after the top record in the ring
+	int count;		// Amount of records
+
+public:
+	UndoStack() : records(new UndoRecord[UNDO_STACK_SIZE]), top(0), count(0) {};
+
+	// Copies take the records in use only
+	UndoStack(const UndoStack& other) : UndoStack()
+	{
+		*this = other;
+	}
+
+	UndoStack& operator=(const UndoStack& other)
+	{
+		if (records == NULL) { records.reset(new UndoRecord[UNDO_STACK_SIZE]); }
+		top = other.top;
+		count = other.count;
+		for (int i = 1; i <= count; i++) { records[(top - i) & (UNDO_STACK_SIZE - 1)] = other.records[(top - i) & (UNDO_STACK_SIZE - 1)]; }
+		return *this;
+	}
+
+	UndoStack(UndoStack&&) = default;
+	UndoStack& operator=(UndoStack&&) = default;
+
+	// Push a record and get it, dropping the oldest one if the stack is full
+	UndoRecord& push()
+	{
+		UndoRecord& r = records[top];
+		top = (top + 1) & (UNDO_STACK_SIZE - 1);
+		if (count < UNDO_STACK_SIZE) { count++; }
+		return r;
+	}
+
+	// Remove the top record. There must be one.
+	void pop()
+	{
+		assert(count > 0);
+		top = (top - 1) & (UNDO_STACK_SIZE - 1);
+		count--;
+	}
+
+	// Remove every record
+	void clear()
+	{
+		count = 0;
+	}
+
+	// Amount of records
+	int size() const
+	{
+		return count;
+	}
+
+	bool empty() const
+	{
+		return count == 0;
+	}
+
+	// Get the top record. There must be one.
+	UndoRecord& back()
+	{
+		return records[(top - 1) & (UNDO_STACK_SIZE - 1)];
+	}
+
+	const UndoRecord& back() const
+	{
+		return records[(top - 1) & (UNDO_STACK_SIZE - 1)];
+	}
+
+	// Get a record by its index from the oldest one
+	const UndoRecord& operator[](int index) const
+	{
+		return records[(top - count + index) & (UNDO_STACK_SIZE - 1)];
+	}
+};
+
+/// Byte88 subclass to represent chess board.
+/// Alongside the bytes, the board keeps bitboards of every piece ID and team,
+/// the Zobrist hash of the pieces (see ZobristKeys, the team to move is not
+/// part of it, and PieceTables for the flags hashed) and the sums of the piece-square scores (see PieceSquareTables).
+/// These are only kept in sync when squares are written through set(), so piece
+/// moves must never write to the board using the index operators. While journal is
+/// set, every write is also recorded in it so the move can be undone.
 struct BoardState : Byte88
 {
+	UINT64 pieceBB[2][16];	// Bitboard of each piece ID, per team
+	UINT64 teamBB[2];		// Bitboard of all pieces of a team
+	UINT64 occupied;		// Bitboard of all occupied squares
+	UINT64 dirty;			// Squares whose piece changed since dirty was last cleared
+	UINT64 hash;			// Zobrist hash of the pieces and their hashed flags
+	int psqMg;				// Middle game material and piece-square score, white minus black
+	int psqEg;				// End game material and piece-square score, white minus black
+	int phase;				// Sum of the game phase weights of the pieces
+	UndoRecord* journal;	// Record of the move being made, or NULL
+	const PieceTables* tables;	// Tables of the pieces of the board, set by its position
+
 	// Create empty byte8x8.
-	BoardState() : Byte88() {};
+	BoardState() : Byte88(), pieceBB{ }, teamBB{ }, occupied(0), dirty(0), hash(0), psqMg(0), psqEg(0), phase(0),
+		journal(NULL), tables(&defaultPieceTables()) {};
 
 	// Create copy of byte8x8.
 	BoardState(const BoardState& b)
 	{
 		memcpy_s(data, 64, b.data, 64);
+		memcpy_s(pieceBB, sizeof(pieceBB), b.pieceBB, sizeof(pieceBB));
+		teamBB[0] = b.teamBB[0];
+		teamBB[1] = b.teamBB[1];
+		occupied = b.occupied;
+		dirty = b.dirty;
+		hash = b.hash;
+		psqMg = b.psqMg;
+		psqEg = b.psqEg;
+		phase = b.phase;
+		journal = NULL;
+		tables = b.tables;
 	}
 
 	// Create a BoardState filled with the same value.
-	BoardState(byte b)
+	BoardState(byte b) : journal(NULL), tables(&defaultPieceTables())
 	{
 		std::fill_n(data, 64, b);
+		syncBitboards();
 	}
 
 	// Create a BoardState from a bit board with custom LOW and HIGH bytes. 
-	BoardState(UINT64 bboard, byte low, byte high) : Byte88()
+	BoardState(UINT64 bboard, byte low, byte high) : Byte88(), journal(NULL), tables(&defaultPieceTables())
 	{
 		for (int i = 0; i < 64; i++)
 		{	// Get bit at position i (LSB) and assign to low/high
@@ -62,12 +207,109 @@ struct BoardState : Byte88
 			// Shift board to the right, making space for next bit
 			bboard >>= 1;
 		}
+		syncBitboards();
 	}
 
 	// Create a BoardState from a pointer. Unsafe.
-	BoardState(byte* ptr)
+	BoardState(byte* ptr) : journal(NULL), tables(&defaultPieceTables())
 	{
 		memcpy_s(data, 64, ptr, 64);
+		syncBitboards();
+	}
+
+	// Rebuild all bitboards, the hash and the scores from the board bytes.
+	void syncBitboards()
+	{
+		dirty = 0;
+		hash = computeHash();
+		computeScores(psqMg, psqEg, phase);
+		occupied = ~toBitboard(PIECE_ID, 0);
+		teamBB[1] = occupied & toBitboard(PIECE_TEAM, PIECE_TEAM);
+		teamBB[0] = occupied & ~teamBB[1];
+		pieceBB[0][0] = pieceBB[1][0] = 0;
+		for (int id = 1; id < 16; id++)
+		{
+			UINT64 bb = findAll((byte)id);
+			pieceBB[0][id] = bb & teamBB[0];
+			pieceBB[1][id] = bb & teamBB[1];
+		}
+	}
+
+	// Compute the Zobrist hash of the pieces from scratch.
+	UINT64 computeHash() const
+	{
+		const ZobristKeys& keys = zobrist();
+		UINT64 h = 0;
+		for (int i = 0; i < 64; i++) { h ^= keys.key(i, data[i], tables->hashedFlags); }
+		return h;
+	}
+
+	// Compute the piece-square score sums and the game phase from scratch.
+	void computeScores(int& mg, int& eg, int& ph) const
+	{
+		const PieceSquareTables& psq = tables->psq;
+		mg = eg = ph = 0;
+		for (int i = 0; i < 64; i++)
+		{
+			if ((data[i] & PIECE_ID) == 0) { continue; }
+			mg += psq.mg[data[i] & 0x1F][i];
+			eg += psq.eg[data[i] & 0x1F][i];
+			ph += psq.phase[data[i] & 0x1F];
+		}
+	}
+
+	// Write a byte at a given index, updating the bitboards, hash, scores and dirty squares.
+	void set(int pos, byte b)
+	{
+		byte old = data[pos];
+		if (journal != NULL)
+		{
+			if (journal->count >= UNDO_MAX_WRITES) { throw std::length_error("Move writes more than UNDO_MAX_WRITES squares"); }
+			journal->squares[journal->count] = (byte)pos;
+			journal->old[journal->count++] = old;
+		}
+		data[pos] = b;
+		const ZobristKeys& keys = zobrist();
+		hash ^= keys.key(pos, old, tables->hashedFlags) ^ keys.key(pos, b, tables->hashedFlags);
+		// Flags changes do not affect the bitboards
+		if (((old ^ b) & (PIECE_ID | PIECE_TEAM)) == 0) { return; }
+		UINT64 bit = SQUARE_BB(pos);
+		dirty |= bit;
+		const PieceSquareTables& psq = tables->psq;
+		psqMg += psq.mg[b & 0x1F][pos] - psq.mg[old & 0x1F][pos];
+		psqEg += psq.eg[b & 0x1F][pos] - psq.eg[old & 0x1F][pos];
+		phase += psq.phase[b & 0x1F] - psq.phase[old & 0x1F];
+		if (old & PIECE_ID)
+		{	// Remove old piece from its bitboards
+			int team = (old & PIECE_TEAM) >> 4;
+			pieceBB[team][old & PIECE_ID] &= ~bit;
+			teamBB[team] &= ~bit;
+			occupied &= ~bit;
+		}
+		if (b & PIECE_ID)
+		{	// Add new piece to its bitboards
+			int team = (b & PIECE_TEAM) >> 4;
+			pieceBB[team][b & PIECE_ID] |= bit;
+			teamBB[team] |= bit;
+			occupied |= bit;
+		}
+	}
+
+	// Write a byte at a given position, updating the bitboards.
+	void set(IVec2 pos, byte b)
+	{
+		set(pos.y << 3 | pos.x, b);
+	}
+
+	// Clear the temporary special flag of every piece. Done at the start of each move.
+	void clearSpTemp()
+	{
+		UINT64 pieces = occupied & toBitboard(PIECE_SPTEMP, PIECE_SPTEMP);
+		while (pieces)
+		{
+			int i = popLsb(pieces);
+			set(i, data[i] & ~PIECE_SPTEMP);
+		}
 	}
 
 	// Get a Piece structure at a given index.
@@ -86,13 +328,12 @@ struct BoardState : Byte88
 	// Set the Piece structure at a given index.
 	void setPiece(int pos, Piece p)
 	{
-		data[pos] = p.getByte();
+		set(pos, p.getByte());
 	}
 
 	// Set the Piece structure at a given position.
 	void setPiece(IVec2 pos, Piece p)
 	{
-		// Shift y by 3 bits and OR with x to get a unique index from 0-63
-		data[pos.y << 3 | pos.x] = p.getByte();
+		set(pos, p.getByte());
 	}
 };
\ No newline at end of file
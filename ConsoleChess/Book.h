@@ -0,0 +1,145 @@
+#pragma once
+#include <string>
+
+#include "Platform.h"
+#include "Position.h"
+#include "MovePicker.h"
+#include "MappedFile.h"
+
+#define BOOK_VERSION 1					// Version of the book file layout
+#define BOOK_DEFAULT_FILE "book.bin"	// Book loaded by the game at startup
+
+// Move of a position in the opening book
+struct BookEntry
+{
+	UINT64 key;		// Zobrist key of the position (see Position::hashKey)
+	UINT16 move;	// Move, packed by SearchMove::pack
+	UINT16 weight;	// How good the move did: 2 points per game won by the team playing it, 1 per draw
+	UINT32 games;	// Amount of games the move was played in
+
+	// Order of the entries in the file, by position then by move
+	bool operator<(const BookEntry& e) const
+	{
+		return key < e.key || (key == e.key && move < e.move);
+	}
+};
+
+// Header of a book file, followed by the entries sorted by key and move
+struct BookHeader
+{
+	char magic[4];		// "CCBK"
+	UINT32 version;		// BOOK_VERSION
+	UINT64 count;		// Amount of entries
+};
+
+// Opening book: the moves played from the positions of a corpus of games, built by the
+// BookGen tool. The file is mapped as it is, the moves of a position are found by a binary
+// search on the sorted entries, so opening a book costs nothing however large it is.
+class Book
+{
+	MappedFile file;			// Mapped book file
+	const BookEntry* entries;	// Entries of the book, sorted
+	UINT64 count;				// Amount of entries
+
+public:
+	Book() : entries(NULL), count(0) { }
+
+	Book(const Book&) = delete;
+	Book& operator=(const Book&) = delete;
+
+	// Map a book file. Returns false (and keeps the book empty) if it is missing or
+	// doesn't hold a book.
+	bool open(const std::string& path)
+	{
+		close();
+		if (!file.open(path)) { return false; }
+		const BookHeader* header = (const BookHeader*)file.data();
+		// The count is checked against the entries the file holds, a product could overflow
+		if (file.size() < sizeof(BookHeader) || memcmp(header->magic, "CCBK", 4) != 0 || header->version != BOOK_VERSION ||
+			header->count > (file.size() - sizeof(BookHeader)) / sizeof(BookEntry))
+		{
+			close();
+			return false;
+		}
+		entries = (const BookEntry*)(file.data() + sizeof(BookHeader));
+		count = header->count;
+		return true;
+	}
+
+	// Unmap the book
+	void close()
+	{
+		file.close();
+		entries = NULL;
+		count = 0;
+	}
+
+	// Amount of entries of the book
+	UINT64 size() const
+	{
+		return count;
+	}
+
+	// Find the entries of a position, in order of their moves. Returns the amount of entries
+	// and sets first to the first one.
+	int find(UINT64 key, const BookEntry*& first) const
+	{
+		// Lower bound of the key
+		UINT64 lo = 0, n = count;
+		while (n > 0)
+		{
+			UINT64 half = n / 2;
+			if (entries[lo + half].key < key)
+			{
+				lo += half + 1;
+				n -= half + 1;
+			}
+			else { n = half; }
+		}
+		first = entries + lo;
+		int cnt = 0;
+		while (lo + cnt < count && entries[lo + cnt].key == key) { cnt++; }
+		return cnt;
+	}
+
+	// Pick a move of the book for the team to move, at random in proportion to the weights
+	// of the moves. Moves which aren't legal (ex. on a key collision) are left out. random is
+	// any random number. Returns false if the book has no move for the position.
+	bool pick(Position& pos, const Legality& legality, UINT64 random, SearchMove& move, UINT32& games) const
+	{
+		const BookEntry* first;
+		int cnt = find(pos.hashKey(), first);
+		SearchMove moves[256];
+		UINT32 played[256];
+		UINT64 weights[256], total = 0;
+		int n = 0;
+		for (int i = 0; i < cnt && n < 256; i++)
+		{
+			SearchMove m = SearchMove::unpack(first[i].move);
+			Move legal;
+			if (first[i].weight == 0 || !pos.findLegalMove(pos.currTeam, m.from, m.to, legal, legality)) { continue; }
+			// A promotion needs a piece to promote to
+			bool promotes = (legal.flags() & MovePromotion) != 0;
+			if (promotes != (m.promotion != 0) || (promotes && !pos.canPromote(m.start(), m.promotion))) { continue; }
+			m.flags = legal.flags();
+			moves[n] = m;
+			played[n] = first[i].games;
+			total += first[i].weight;
+			weights[n++] = total;
+		}
+		if (total == 0) { return false; }
+		UINT64 r = random % total;
+		int i = 0;
+		while (weights[i] <= r) { i++; }
+		move = moves[i];
+		games = played[i];
+		return true;
+	}
+};
+
+// Get the opening book of the game
+inline Book& book()
+{
+	static Book b;
+	return b;
+}
@@ -1,24 +1,99 @@
 #pragma once
+#include <algorithm>
+#include <cstring>
 #include "IVec2.h"
-#include <Windows.h>
+#include "Platform.h"
+
+// The element-wise operators work on 32 bytes at a time with AVX2 (/arch:AVX2 or -mavx2),
+// 16 with SSE2 otherwise on x86, and 8 (in a UINT64) elsewhere. Define BYTE88_SCALAR to use
+// the 8 byte version everywhere.
+#if !defined(BYTE88_SCALAR) && defined(__AVX2__)
+#define BYTE88_AVX2
+#include <immintrin.h>
+#elif !defined(BYTE88_SCALAR) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define BYTE88_SSE2
+#include <emmintrin.h>
+#endif
+
+// Byte88 data is aligned on a cache line when heap allocations honor it (C++17 aligned
+// new). The operators don't need it, they use unaligned loads.
+#ifdef __cpp_aligned_new
+#define BYTE88_ALIGN alignas(64)
+#else
+#define BYTE88_ALIGN
+#endif
 
 // Macro to convert a board vector position to its index
 #define POS_TO_INDEX(pos) ((pos).y << 3 | (pos).x)
 
+// Lane of bytes the Byte88 operators work on, the widest register the target has.
+// Shifts move the bits of each byte separately, like a shift of a byte.
+struct ByteLane
+{
+#if defined(BYTE88_AVX2)
+	typedef __m256i V;
+	static const int Size = 32;
+
+	static V load(const byte* p) { return _mm256_loadu_si256((const V*)p); }
+	static void store(byte* p, V v) { _mm256_storeu_si256((V*)p, v); }
+	static V splat(byte b) { return _mm256_set1_epi8((char)b); }
+	static V vand(V a, V b) { return _mm256_and_si256(a, b); }
+	static V vor(V a, V b) { return _mm256_or_si256(a, b); }
+	static V vxor(V a, V b) { return _mm256_xor_si256(a, b); }
+	static V add(V a, V b) { return _mm256_add_epi8(a, b); }
+	static V sub(V a, V b) { return _mm256_sub_epi8(a, b); }
+	static V shr(V a, int n) { return vand(_mm256_srl_epi16(a, _mm_cvtsi32_si128(n)), splat(n < 8 ? 0xFF >> n : 0)); }
+	static V shl(V a, int n) { return vand(_mm256_sll_epi16(a, _mm_cvtsi32_si128(n)), splat(n < 8 ? 0xFF << n : 0)); }
+	// Bit i set if byte i is equal in both lanes
+	static UINT64 equal(V a, V b) { return (unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(a, b)); }
+#elif defined(BYTE88_SSE2)
+	typedef __m128i V;
+	static const int Size = 16;
+
+	static V load(const byte* p) { return _mm_loadu_si128((const V*)p); }
+	static void store(byte* p, V v) { _mm_storeu_si128((V*)p, v); }
+	static V splat(byte b) { return _mm_set1_epi8((char)b); }
+	static V vand(V a, V b) { return _mm_and_si128(a, b); }
+	static V vor(V a, V b) { return _mm_or_si128(a, b); }
+	static V vxor(V a, V b) { return _mm_xor_si128(a, b); }
+	static V add(V a, V b) { return _mm_add_epi8(a, b); }
+	static V sub(V a, V b) { return _mm_sub_epi8(a, b); }
+	static V shr(V a, int n) { return vand(_mm_srl_epi16(a, _mm_cvtsi32_si128(n)), splat(n < 8 ? 0xFF >> n : 0)); }
+	static V shl(V a, int n) { return vand(_mm_sll_epi16(a, _mm_cvtsi32_si128(n)), splat(n < 8 ? 0xFF << n : 0)); }
+	static UINT64 equal(V a, V b) { return (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(a, b)); }
+#else
+	typedef UINT64 V;
+	static const int Size = 8;
+
+	static V load(const byte* p) { V v; memcpy(&v, p, 8); return v; }
+	static void store(byte* p, V v) { memcpy(p, &v, 8); }
+	static V splat(byte b) { return 0x0101010101010101ULL * b; }
+	static V vand(V a, V b) { return a & b; }
+	static V vor(V a, V b) { return a | b; }
+	static V vxor(V a, V b) { return a ^ b; }
+	// Add the low 7 bits, then the top bits without carry
+	static V add(V a, V b) { return ((a & ~splat(0x80)) + (b & ~splat(0x80))) ^ ((a ^ b) & splat(0x80)); }
+	static V sub(V a, V b) { return ((a | splat(0x80)) - (b & ~splat(0x80))) ^ ((a ^ ~b) & splat(0x80)); }
+	static V shr(V a, int n) { return n < 8 ? (a >> n) & splat(0xFF >> n) : 0; }
+	static V shl(V a, int n) { return n < 8 ? (a << n) & splat((byte)(0xFF << n)) : 0; }
+	static UINT64 equal(V a, V b)
+	{
+		UINT64 m = 0;
+		V x = a ^ b;
+		for (int i = 0; i < 8; i++) { m |= (UINT64)((x >> (8 * i) & 0xFF) == 0) << i; }
+		return m;
+	}
+#endif
+};
+
 // Small struct equivalent to an 8x8 byte array.
 // Used to store sprites, boards, etc.
-struct Byte88
+struct BYTE88_ALIGN Byte88
 {
 	byte data[64]; // Internal data of the Byte88
 
 	// Create empty byte88.
 	Byte88() : data{} {};
-	
-	// Create copy of byte88.
-	Byte88(const Byte88& b)
-	{	// Copy data of b to this->data
-		memcpy_s(data, 64, b.data, 64);
-	}
 
 	// Create Byte88 initalized with a single value
 	Byte88(byte b) 
@@ -37,60 +112,91 @@ struct Byte88
 	}
 
 	// Create a byte8x8 from a pointer. Unsafe.
-	Byte88(byte* ptr)
+	Byte88(const byte* ptr)
 	{	// Copy 64 bytes from ptr to this->data
-		memcpy_s(data, 64, ptr, 64);
+		memcpy(data, ptr, 64);
+	}
+
+	// Get the bitboard of the squares whose byte, masked, is equal to a value
+	UINT64 toBitboard(byte mask, byte value) const
+	{
+		UINT64 bb = 0;
+		ByteLane::V m = ByteLane::splat(mask), v = ByteLane::splat(value);
+		for (int i = 0; i < 64; i += ByteLane::Size)
+		{
+			bb |= ByteLane::equal(ByteLane::vand(ByteLane::load(data + i), m), v) << i;
+		}
+		return bb;
+	}
+
+	// Get the bitboard of the squares holding a piece ID, of either team
+	UINT64 findAll(byte id) const
+	{
+		return toBitboard(0x0F, id);
+	}
+
+	// Get the bitboard of the non zero squares
+	UINT64 nonZero() const
+	{
+		return ~toBitboard(0xFF, 0);
 	}
 
 	// OPERATORS
 	// All operators are defined in a similar fashion. For each operation,
 	// we implement the operator (as const) and its assignment variant (ie. +=).
-	// Every operation is made element-wise with another Byte88 using a for loop.
+	// The operations which have a SIMD equivalent are made on a ByteLane at a time
+	// (see zip and map), the others element-wise using a for loop.
 	// assignment operators return the object.
 
-	Byte88& operator+= (Byte88 & b) 
-	{										
-		for (int i = 0; i < 64; i++)		
-		{									
-			data[i] += b.data[i];		
-		}									
-		return *this;						
-	}	
-	
-	Byte88 operator+ (Byte88 & b) const
-	{			
-		Byte88 cpy = Byte88(*this);
-		cpy += b;
-		return cpy;
-	}
-
-	Byte88 operator-() const
+	// Combine with another Byte88 a lane at a time
+	template<typename F> Byte88& zip(const Byte88& b, F f)
 	{
-		Byte88 cpy = Byte88(*this);
-		for (int i = 0; i < 64; i++)
+		for (int i = 0; i < 64; i += ByteLane::Size)
 		{
-			cpy.data[i] = -data[i];
+			ByteLane::store(data + i, f(ByteLane::load(data + i), ByteLane::load(b.data + i)));
 		}
-		return cpy;
+		return *this;
 	}
 
-	Byte88& operator-= (Byte88& b)
+	// Transform a lane at a time
+	template<typename F> Byte88& map(F f)
 	{
-		for (int i = 0; i < 64; i++)
+		for (int i = 0; i < 64; i += ByteLane::Size)
 		{
-			data[i] -= b.data[i];
+			ByteLane::store(data + i, f(ByteLane::load(data + i)));
 		}
 		return *this;
 	}
 
-	Byte88 operator- (Byte88& b) const
+	Byte88& operator+= (const Byte88& b)
 	{
-		Byte88 cpy = Byte88(*this);
-		cpy -= b;
-		return cpy;
+		return zip(b, ByteLane::add);
 	}
 
-	Byte88& operator*= (Byte88& b)
+	Byte88 operator+ (const Byte88& b) const
+	{
+		Byte88 cpy = *this;
+		return cpy += b;
+	}
+
+	Byte88 operator-() const
+	{
+		Byte88 cpy = *this;
+		return cpy.map([](ByteLane::V a) { return ByteLane::sub(ByteLane::splat(0), a); });
+	}
+
+	Byte88& operator-= (const Byte88& b)
+	{
+		return zip(b, ByteLane::sub);
+	}
+
+	Byte88 operator- (const Byte88& b) const
+	{
+		Byte88 cpy = *this;
+		return cpy -= b;
+	}
+
+	Byte88& operator*= (const Byte88& b)
 	{
 		for (int i = 0; i < 64; i++)
 		{
@@ -99,14 +205,13 @@ struct Byte88
 		return *this;
 	}
 
-	Byte88 operator* (Byte88& b) const
+	Byte88 operator* (const Byte88& b) const
 	{
-		Byte88 cpy = Byte88(*this);
-		cpy *= b;
-		return cpy;
+		Byte88 cpy = *this;
+		return cpy *= b;
 	}
 
-	Byte88& operator/= (Byte88& b)
+	Byte88& operator/= (const Byte88& b)
 	{
 		for (int i = 0; i < 64; i++)
 		{
@@ -115,110 +220,82 @@ struct Byte88
 		return *this;
 	}
 
-	Byte88 operator/ (Byte88& b) const
+	Byte88 operator/ (const Byte88& b) const
 	{
-		Byte88 cpy = Byte88(*this);
-		cpy /= b;
-		return cpy;
+		Byte88 cpy = *this;
+		return cpy /= b;
 	}
 
-	Byte88& operator|= (Byte88& b)
+	Byte88& operator|= (const Byte88& b)
 	{
-		for (int i = 0; i < 64; i++)
-		{
-			data[i] |= b.data[i];
-		}
-		return *this;
+		return zip(b, ByteLane::vor);
 	}
 
-	Byte88 operator| (Byte88& b) const
+	Byte88 operator| (const Byte88& b) const
 	{
-		Byte88 cpy = Byte88(*this);
-		cpy |= b;
-		return cpy;
+		Byte88 cpy = *this;
+		return cpy |= b;
 	}
 
 	Byte88& operator|= (byte b)
 	{
-		for (int i = 0; i < 64; i++)
-		{
-			data[i] |= b;
-		}
-		return *this;
+		ByteLane::V v = ByteLane::splat(b);
+		return map([v](ByteLane::V a) { return ByteLane::vor(a, v); });
 	}
 
 	Byte88 operator| (byte b) const
 	{
-		Byte88 cpy = Byte88(*this);
-		cpy |= b;
-		return cpy;
+		Byte88 cpy = *this;
+		return cpy |= b;
 	}
 
-	Byte88& operator&= (Byte88& b)
+	Byte88& operator&= (const Byte88& b)
 	{
-		for (int i = 0; i < 64; i++)
-		{
-			data[i] &= b.data[i];
-		}
-		return *this;
+		return zip(b, ByteLane::vand);
 	}
 
-	Byte88 operator& (Byte88& b) const
+	Byte88 operator& (const Byte88& b) const
 	{
-		Byte88 cpy = Byte88(*this);
-		cpy &= b;
-		return cpy;
+		Byte88 cpy = *this;
+		return cpy &= b;
 	}
 
 	Byte88& operator&= (byte b)
 	{
-		for (int i = 0; i < 64; i++)
-		{
-			data[i] &= b;
-		}
-		return *this;
+		ByteLane::V v = ByteLane::splat(b);
+		return map([v](ByteLane::V a) { return ByteLane::vand(a, v); });
 	}
 
 	Byte88 operator& (byte b) const
 	{
-		Byte88 cpy = Byte88(*this);
-		cpy &= b;
-		return cpy;
+		Byte88 cpy = *this;
+		return cpy &= b;
 	}
 
-	Byte88& operator^= (Byte88& b)
+	Byte88& operator^= (const Byte88& b)
 	{
-		for (int i = 0; i < 64; i++)
-		{
-			data[i] ^= b.data[i];
-		}
-		return *this;
+		return zip(b, ByteLane::vxor);
 	}
 
-	Byte88 operator^ (Byte88& b) const
+	Byte88 operator^ (const Byte88& b) const
 	{
-		Byte88 cpy = Byte88(*this);
-		cpy ^= b;
-		return cpy;
+		Byte88 cpy = *this;
+		return cpy ^= b;
 	}
 
 	Byte88& operator^= (byte b)
 	{
-		for (int i = 0; i < 64; i++)
-		{
-			data[i] ^= b;
-		}
-		return *this;
+		ByteLane::V v = ByteLane::splat(b);
+		return map([v](ByteLane::V a) { return ByteLane::vxor(a, v); });
 	}
 
 	Byte88 operator^ (byte b) const
 	{
-		Byte88 cpy = Byte88(*this);
-		cpy ^= b;
-		return cpy;
+		Byte88 cpy = *this;
+		return cpy ^= b;
 	}
 
-	Byte88& operator>>= (Byte88& b)
+	Byte88& operator>>= (const Byte88& b)
 	{
 		for (int i = 0; i < 64; i++)
 		{
@@ -227,30 +304,24 @@ struct Byte88
 		return *this;
 	}
 
-	Byte88 operator>> (Byte88& b) const
+	Byte88 operator>> (const Byte88& b) const
 	{
-		Byte88 cpy = Byte88(*this);
-		cpy >>= b;
-		return cpy;
+		Byte88 cpy = *this;
+		return cpy >>= b;
 	}
 
 	Byte88& operator>>= (byte b)
 	{
-		for (int i = 0; i < 64; i++)
-		{
-			data[i] >>= b;
-		}
-		return *this;
+		return map([b](ByteLane::V a) { return ByteLane::shr(a, b); });
 	}
 
 	Byte88 operator>> (byte b) const
 	{
-		Byte88 cpy = Byte88(*this);
-		cpy >>= b;
-		return cpy;
+		Byte88 cpy = *this;
+		return cpy >>= b;
 	}
 
-	Byte88& operator<<= (Byte88& b)
+	Byte88& operator<<= (const Byte88& b)
 	{
 		for (int i = 0; i < 64; i++)
 		{
@@ -259,37 +330,27 @@ struct Byte88
 		return *this;
 	}
 
-	Byte88 operator<< (Byte88& b) const
+	Byte88 operator<< (const Byte88& b) const
 	{
-		Byte88 cpy = Byte88(*this);
-		cpy <<= b;
-		return cpy;
+		Byte88 cpy = *this;
+		return cpy <<= b;
 	}
 
 	Byte88& operator<<= (byte b)
 	{
-		for (int i = 0; i < 64; i++)
-		{
-			data[i] <<= b;
-		}
-		return *this;
+		return map([b](ByteLane::V a) { return ByteLane::shl(a, b); });
 	}
 
 	Byte88 operator<< (byte b) const
 	{
-		Byte88 cpy = Byte88(*this);
-		cpy <<= b;
-		return cpy;
+		Byte88 cpy = *this;
+		return cpy <<= b;
 	}
 
 	Byte88 operator~() const
 	{
-		Byte88 cpy = Byte88(*this);
-		for (int i = 0; i < 64; i++)
-		{
-			cpy.data[i] = ~cpy.data[i];
-		}
-		return cpy;
+		Byte88 cpy = *this;
+		return cpy ^= 0xFF;
 	}
 
 	// INDEX OPERATORS
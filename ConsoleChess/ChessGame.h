@@ -1,11 +1,15 @@
 #pragma once
 
 #include <Windows.h>
+#include <random>
 #include <vector>
 
+#include "Book.h"
 #include "GameWindow.h"
-#include "PieceDef.h"
-#include "BoardState.h"
+#include "Position.h"
+#include "SmpSearch.h"
+#include "Tablebase.h"
+#include "TranspositionTable.h"
 
 // Sprite used for potential moves and king in check marks
 static const Byte88 TgtSqrSprite = Byte88(new byte[64]
@@ -55,11 +59,13 @@ enum GameState
 	InProgress,
 	Checkmate,
 	Stalemate,
-	Promoting
+	Promoting,
+	Repetition,	// Draw, the position occurred for the third time
+	FiftyMoves	// Draw, fifty moves of each team without a capture or a pawn move
 };
 
 // Main class defining the behaviour of the chess game
-class ChessGame
+class ChessGame : public Position
 {
 private:
 	GameWindow window; // The game window
@@ -67,19 +73,17 @@ private:
 	IVec2 hoverSqr;	// Square on which the mouse is located
 	IVec2 selectedSqr; // Square of selected piece
 	Byte88 attackedCrits; // Used as bool array for attacked crit pieces
-	Byte88 legalMoves[64]; // Array of 64 byte88s containing the legal moves for each piece for the current turn
-	BoardState prvBoard; // Previous board state
+	Legality legality; // Legality filter of the current team for the current turn
+	std::vector<Move> legalMoves; // Legal moves of the selected piece, computed when it is selected
 
 	int gameState; // Current game state
 
-	void init(std::vector<PieceDef*> pieces)
-	{
-		// Assign the pieces in PieceDefs at their ID
-		for (int i = 0; i < pieces.size(); i++)
-		{
-			pieceDefs[pieces[i]->id] = pieces[i];
-		}
+	TranspositionTable tt;	// Hash table of the AI
+	SmpSearch ai;			// Search of the AI player, on every core
+	std::mt19937_64 rng;	// Random numbers of the AI, to vary its book moves
 
+	void init()
+	{
 		// Create game window and setup color-related stuff
 		window = GameWindow();
 		window.onKeyEvent = [this](KEY_EVENT_RECORD evt) { onKey(evt); };
@@ -126,148 +130,75 @@ private:
 	}
 public:
 
-	PieceDef* pieceDefs[16];	// Array of pointers to PieceDef
-	BoardState board;			// Current board state
 	BoardState startingBoard;	// Initial board state
-
-	byte currTeam; // Current team/color
+	bool aiPlays[2];			// True for the teams played by the AI
+	long long aiTime;			// Thinking time of the AI per move, in ms
 
 	// Class constructor (default)
-	ChessGame(std::vector<PieceDef*> pieces) : startingBoard(), pieceDefs{ }
+	ChessGame(std::vector<PieceDef*> pieces) : Position(pieces), tt(16), ai(&tt, std::thread::hardware_concurrency()),
+		rng(std::random_device()()), startingBoard(), aiPlays{ false, false }, aiTime(2000)
 	{
-		init(pieces);
+		// Resolve the standard pieces at compile time, other piece sets go through PieceDef
+		usePieceSet(PieceSetStandard);
+		init();
 	};
 	// Constructor (w/state)
-	ChessGame(std::vector<PieceDef*> pieces, BoardState bstate) : startingBoard(bstate), pieceDefs{ }
+	ChessGame(std::vector<PieceDef*> pieces, const BoardState& bstate) : Position(pieces), tt(16), ai(&tt, std::thread::hardware_concurrency()),
+		rng(std::random_device()()), startingBoard(bstate), aiPlays{ false, false }, aiTime(2000)
 	{
-		init(pieces);
+		// Resolve the standard pieces at compile time, other piece sets go through PieceDef
+		usePieceSet(PieceSetStandard);
+		init();
 	};
 
-	// Check if piece is attacked using a brute force approach
-	bool isAttacked(IVec2 pos)
-	{
-		// Get target piece
-		Piece tgt = board.getPiece(pos);
-		if (tgt.id == 0) { return false; } // Can't attack a nonexistent piece
-		// Go through all squares on the board
-		for (int i = 0; i < 8; i++)
-		{
-			for (int j = 0; j < 8; j++)
-			{
-				IVec2 v = IVec2(i, j);
-				// Check if piece at that position of the board can attack the target
-				Piece att = board.getPiece(v);
-				if (att.id != 0 && att.team != tgt.team && pieceDefs[att.id]->isValidMove(v, pos, board))
-				{
-					return true;
-				}
-			}
-		}
-		return false;
-	}
-
-	// Make a move (without updating the rendered chess board).
-	bool makeMove(IVec2 start, IVec2 end)
-	{
-		// Push copy of current board state
-		prvBoard = BoardState(board);
-		// Clear temp special bit
-		board &= ~PIECE_SPTEMP;
-		// Let piece perform the move
-		Piece p = board.getPiece(start);
-		bool promote = pieceDefs[p.id]->makeMove(start, end, board);
-		// Change current playing team
-		currTeam ^= 1;
-		// Return promotion flag
-		return promote;
-	}
-
-	// Undo a move (without updating the rendered chess board).
-	void undoMove()
-	{
-		// Copy current board and revert to prv. position
-		BoardState temp = BoardState(board);
-		board = prvBoard;
-		prvBoard = temp;
-		// Change current playing team
-		currTeam ^= 1;
-	}
-
-	// Return true if any critical pieces are under attack
-	bool inCheck(bool team)
-	{	// Go through every square
-		for (int i = 0; i < 8; i++)
-		{
-			for (int j = 0; j < 8; j++)
-			{
-				// Check if the piece is a crit, and if yes check if it's attacked
-				IVec2 v = IVec2(i, j);
-				Piece p = board.getPiece(v);
-				if (p.id == 0 || p.team != team) { continue; }
-				if (pieceDefs[p.id]->critical && isAttacked(v)) { return true; }
-			}
-		}
-		return false;
-	}
-
 	// Compute critical pieces in check inside attackedCrits and return # of checks
 	int computeChecks(bool team)
 	{	// setup list of attacked crit pieces
 		attackedCrits = Byte88();
+		if (legality.usable && legality.team == team)
+		{	// The legality filter already found the checkers of the only crit piece
+			if (legality.crit < 0 || legality.checkers == 0) { return 0; }
+			attackedCrits[legality.crit] = 1;
+			return 1;
+		}
 		int cnt = 0;
-		// Go through all squares
-		for (int i = 0; i < 8; i++)
+		// Go through all pieces of the team
+		UINT64 pieces = board.teamBB[team];
+		while (pieces)
 		{
-			for (int j = 0; j < 8; j++)
-			{
-				// Check if piece is crit and attacked
-				IVec2 v = IVec2(i, j);
-				Piece p = board.getPiece(v);
-				if (p.id == 0 || p.team != team) { continue; }
-				if (pieceDefs[p.id]->critical && isAttacked(v))
-				{	// Set to true in attackedCrits
-					attackedCrits[v] = 1;
-					cnt++; // Increment check counter
-				}
+			// Check if piece is crit and attacked
+			int i = popLsb(pieces);
+			IVec2 v = IVec2(i & 7, i >> 3);
+			if (pieceDefs[board[i] & PIECE_ID]->critical && isAttacked(v))
+			{	// Set to true in attackedCrits
+				attackedCrits[v] = 1;
+				cnt++; // Increment check counter
 			}
 		}
 		return cnt;
 	}
 
-	// Calculate the legal moves of the current team, and return the amount
-	// Very inefficient, but C++ is so fast it does not matter
-	int calculateLegalMoves(bool team)
+	// Select a square, and calculate the legal moves of the piece on it while the game is
+	// in progress. (-1, -1) deselects.
+	void selectSquare(IVec2 sqr)
 	{
-		int cnt = 0;
-		// iterate through all squares
-		for (int k = 0; k < 64; k++)
+		selectedSqr = sqr;
+		legalMoves.clear();
+		if (gameState != InProgress || !sqr.in88Square()) { return; }
+		MoveList moves;
+		int cnt = generatePieceLegalMoves(POS_TO_INDEX(sqr), moves, legality);
+		legalMoves.assign(moves.moves, moves.moves + cnt);
+	}
+
+	// Check if a move is in the legal moves of the selected piece
+	bool isLegalMove(IVec2 start, IVec2 end)
+	{
+		if (start != selectedSqr) { return false; }
+		for (const Move& m : legalMoves)
 		{
-			// Check if piece is of the curr. team
-			IVec2 v = IVec2(k & 7, k >> 3);
-			Piece p = board.getPiece(k);
-			legalMoves[k] = Byte88();
-			if (p.team != team || p.id == 0) continue;
-			// Go through all squares for possible moves
-			for (int i = 0; i < 8; i++)
-			{
-				for (int j = 0; j < 8; j++)
-				{
-					IVec2 u = IVec2(i, j);
-					// If move is pseudolegal, perform it and see if it leads to check
-					if (pieceDefs[p.id]->isValidMove(v, u, board))
-					{
-						makeMove(v, u);
-						if (!inCheck(team))
-						{
-							legalMoves[k][u] = 1;
-							cnt++;
-						}
-						undoMove();
-					}
-				}
-			}
+			if (m.end() == end) { return true; }
 		}
-		return cnt;
+		return false;
 	}
 
 	// Updates the graphical interface.
@@ -293,7 +224,7 @@ public:
 				Piece piece = board.getPiece(pos);
 				Byte88 sprite;
 
-				if (selectedSqr.x != -1 && legalMoves[selectedSqr.y << 3 | selectedSqr.x][pos])
+				if (selectedSqr.x != -1 && isLegalMove(selectedSqr, pos))
 				{	// If square is a legal move of the selected piece, draw green tgtSqrSprite
 					sprite = TgtSqrSprite & 0xe0; // bitwise op. to change color
 					window.layers[LayerMoves].drawSprite(sprite, 8 * pos, Transparent << 4);
@@ -314,9 +245,11 @@ public:
 
 		// Clear text layer
 		window.layers[LayerText].setAll(Transparent << 4);
-		if (gameState == Stalemate)
-		{	// Stalement, announce the draw
+		if (gameState == Stalemate || gameState == Repetition || gameState == FiftyMoves)
+		{	// Stalement or draw rule, announce the draw and the rule
 			window.spriteText("DRAW!", LayerText, IVec2(12, 16));
+			if (gameState == Repetition) { window.spriteText("REPEAT", LayerText, IVec2(8, 32)); }
+			if (gameState == FiftyMoves) { window.spriteText(" FIFTY \n MOVES", LayerText, IVec2(4, 32)); }
 		}
 		else if (gameState != Promoting)
 		{
@@ -326,7 +259,7 @@ public:
 			byte outline = (team ? WhiteOutline : BlackOutline) << 4;
 			window.spriteText(team ? "WHITE" : "BLACK", LayerText, IVec2(12, 8), Transparent << 4, fill, outline);
 			// Draw appropriate message depending on game state
-			const char* msg = (gameState == InProgress) ? " CLICK \nTO MOVE" : " WINS! ";
+			const char* msg = (gameState != InProgress) ? " WINS! " : aiPlays[team] ? "  AI   \n THINKS" : " CLICK \nTO MOVE";
 			window.spriteText(msg, LayerText, IVec2(4, 16));
 		}
 		else 
@@ -335,11 +268,8 @@ public:
 			int j = 0;
 			for (int i = 0; i < 16; i++)
 			{
-				// Avoid NULL pointer
-				if (pieceDefs[i] == NULL) { continue; }
-				// Can't promote to self or critical
-				if (board.getPiece(selectedSqr).id == i) { continue; }
-				if (pieceDefs[i]->critical) { continue; }
+				// Skip pieces which can't be promoted to
+				if (!canPromote(selectedSqr, i)) { continue; }
 				// Get white sprite for piece
 				Byte88 sprite = (pieceDefs[i]->sprite >> 1) & 0xf0;
 				// Display pieces
@@ -354,17 +284,15 @@ public:
 	// Begin a game from the initial state.
 	void beginGame()
 	{
-		// Reset board to starting board
-		board = BoardState(startingBoard);
-		// Set default values for gameState, currTeam, etc.
+		// Reset board to starting board, white to move
+		setBoard(startingBoard, 1);
+		// Set default values for gameState, etc.
 		gameState = InProgress;
-		currTeam = 1;
 		hoverSqr = IVec2(-1, -1);
-		selectedSqr = IVec2(-1, -1);
+		selectSquare(IVec2(-1, -1));
 		attackedCrits = Byte88();
-		prvBoard = BoardState();
-		// Calculate legal moves of current team
-		calculateLegalMoves(currTeam);
+		// Calculate the legality filter of current team, moves are calculated on selection
+		computeLegality(legality, currTeam);
 		// Redraw board
 		redraw();
 	}
@@ -373,13 +301,62 @@ public:
 	void mainloop()
 	{	// Init game
 		beginGame();
-		// Read key and mouse events forever
+		// Read key and mouse events forever, the AI moves as soon as it's its turn
 		while (true)
 		{
-			window.eventTick();
+			if (aiToMove()) { playAiMove(); }
+			// Don't wait for events if the AI plays the next move too
+			if (!aiToMove() || window.hasEvents()) { window.eventTick(); }
 		}
 	}
 
+	// Set the amount of threads the AI searches with (all cores by default)
+	void setAiThreads(int threads)
+	{
+		ai.setThreads(threads);
+	}
+
+	// True if the AI has to play the current move
+	bool aiToMove()
+	{
+		return gameState == InProgress && aiPlays[currTeam];
+	}
+
+	// Let the AI search and play a move for the current team. Moves of the opening book
+	// are played without searching. The search works on its own copy of the position,
+	// and its depth and speed are shown in the window title.
+	void playAiMove()
+	{
+		char title[128];
+		SearchMove move;
+		UINT32 games;
+		if (book().pick(*this, legality, rng(), move, games))
+		{
+			sprintf_s(title, "Console Chess - %s AI: book move, played in %u games", currTeam ? "White" : "Black", games);
+		}
+		else
+		{
+			move = ai.think(*this, aiTime);
+			if (move.isNull()) { return; }
+			// Report the search in the console title
+			const SearchInfo& info = ai.info;
+			if (info.mateIn() != 0)
+			{
+				sprintf_s(title, "Console Chess - %s AI: depth %d, %llu kN/s, mate in %d", currTeam ? "White" : "Black",
+					info.depth, info.nps() / 1000, info.mateIn());
+			}
+			else
+			{
+				sprintf_s(title, "Console Chess - %s AI: depth %d, %llu kN/s, score %+.2f", currTeam ? "White" : "Black",
+					info.depth, info.nps() / 1000, info.score / 100.0);
+			}
+		}
+		SetConsoleTitleA(title);
+		// Play the move
+		if (makeMove(move.start(), move.end()) && move.promotion != 0) { promote(move.end(), move.promotion); }
+		finalizeMove();
+	}
+
 	// Event handler, called during a key press.
 	void onKey(KEY_EVENT_RECORD evt)
 	{
@@ -391,24 +368,62 @@ public:
 		{	// Shortcut to restart the game
 			beginGame();
 		}
+		if (evt.bKeyDown && (evt.wVirtualKeyCode == 'W' || evt.wVirtualKeyCode == 'B'))
+		{	// Toggle the AI for white using 'w' and for black using 'b'
+			aiPlays[evt.wVirtualKeyCode == 'W'] ^= true;
+			redraw();
+		}
+		if (evt.bKeyDown && evt.wVirtualKeyCode == 'U')
+		{	// Take back moves using 'u', once per press
+			takeBack();
+		}
+	}
+
+	// Take back the last move (or the unfinished promotion). Against the AI, its reply is
+	// taken back with the player's move so the player moves again. Can be repeated back
+	// to the start of the game.
+	void takeBack()
+	{
+		if (undoDepth() == 0) { return; }
+		undoMove();
+		if (aiPlays[currTeam] && !aiPlays[currTeam ^ 1] && undoDepth() > 0) { undoMove(); }
+		finalizeMove();
 	}
 
 	// Called to clean up the game state after a move is completely done
 	void finalizeMove()
 	{
-		// Compute crits, and legal moves for current team
-		Byte88 prvCrits = Byte88(attackedCrits);
-		int nLegalMoves = calculateLegalMoves(currTeam);
+		// Compute the legality filter and crits for current team
+		computeLegality(legality, currTeam);
 		int nChecks = computeChecks(currTeam);
 
-		// Check for game end
-		if (nLegalMoves == 0) gameState = (nChecks != 0) ? Checkmate : Stalemate;
+		// Check for game end, stopping at the first legal move. The legal moves of a piece
+		// are only calculated when it is selected.
+		if (!hasAnyLegalMove(currTeam, legality)) gameState = (nChecks != 0) ? Checkmate : Stalemate;
+		// Draw rules, a position seen twice before since the last irreversible move
+		else if (repetitions() >= 2) gameState = Repetition;
+		else if (fiftyMoveDraw()) gameState = FiftyMoves;
 		else gameState = InProgress;
+		// Announce the forced result of the position if it is in the endgame tables
+		TbResult tb;
+		if (gameState == InProgress && tablebases().probe(*this, tb)) { announce(tb); }
 		// Deselect square
-		selectedSqr = IVec2(-1, -1);
+		selectSquare(IVec2(-1, -1));
 		redraw();
 	}
 
+	// Show the result of a tablebase position in the console title
+	void announce(const TbResult& tb)
+	{
+		char title[128];
+		const char* mover = currTeam ? "White" : "Black";
+		const char* other = currTeam ? "Black" : "White";
+		if (tb.wdl == 0) { sprintf_s(title, "Console Chess - Tablebase: draw"); }
+		else if (tb.wdl > 0) { sprintf_s(title, "Console Chess - Tablebase: %s mates in %d", mover, (tb.distance + 1) / 2); }
+		else { sprintf_s(title, "Console Chess - Tablebase: %s mates in %d", other, tb.distance / 2); }
+		SetConsoleTitleA(title);
+	}
+
 	// Event handler, called during a mouse event.
 	void onMouse(MOUSE_EVENT_RECORD evt)
 	{	// Get current mouse and board position
@@ -427,12 +442,12 @@ public:
 			{	// Check if clicking on a non-current team square
 				if (board[boardPos] == 0 || board.getPiece(boardPos).team != currTeam)
 				{	// If piece is selected and we are clicking on a legal move
-					if (selectedSqr.in88Square() && legalMoves[selectedSqr.y << 3 | selectedSqr.x][boardPos])
+					if (selectedSqr.in88Square() && isLegalMove(selectedSqr, boardPos))
 					{	// Move piece and check if promoting:
 						if (makeMove(selectedSqr, boardPos)) 
 						{	// Promote state, fix the selected square to the piece's new position
 							gameState = Promoting;
-							selectedSqr = boardPos;
+							selectSquare(boardPos);
 							redraw();
 						}
 						else
@@ -443,7 +458,7 @@ public:
 				}
 				else
 				{	// Clicked on a current team square, change selected piece
-					selectedSqr = boardPos;
+					selectSquare(boardPos);
 					redraw();
 				}
 			}
@@ -453,17 +468,14 @@ public:
 				int j = 0;
 				for (int i = 0; i < 16; i++)
 				{
-					// Avoid NULL pointer
-					if (pieceDefs[i] == NULL) { continue; }
-					// Can't promote to self or critical
-					if (board.getPiece(selectedSqr).id == i) { continue; }
-					if (pieceDefs[i]->critical) { continue; }
+					// Skip pieces which can't be promoted to
+					if (!canPromote(selectedSqr, i)) { continue; }
 					// Get piece corner position in console
 					IVec2 v = IVec2(77 + 10 * (j % 4), 10 + 10 * (j / 4));
 					// If user clicked on this piece
 					if ((curPos - v).in88Square()) 
 					{	// Set piece to chosen one, but keep piece team
-						board[selectedSqr] = (board[selectedSqr] & PIECE_TEAM) | pieceDefs[i]->id;
+						promote(selectedSqr, pieceDefs[i]->id);
 						finalizeMove();
 						break;
 					}
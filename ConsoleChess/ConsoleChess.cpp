@@ -4,54 +4,23 @@
 #include <Windows.h>
 #include <vector>
 
+#include "Book.h"
 #include "ChessGame.h"
-#include "UnitMovePiece.h"
-
-#include "SpriteDefs.h"
-#include "Pawn.h"
-#include "King.h"
+#include "Nnue.h"
+#include "Tablebase.h"
+#include "StandardPieces.h"
 
 int main()
 {
-	// Pawn definition
-	Pawn pawn = Pawn(1, PawnSprite);
-	// Bishop definition
-	UnitMovePiece bishop = UnitMovePiece(2, false, false, BishopSprite);
-	bishop.generateMoveset(std::vector<IVec2> {IVec2(1, 1)}, Rotate90, true);
-	// Knight definition
-	UnitMovePiece knight = UnitMovePiece(3, false, true, KnightSprite);
-	knight.generateMoveset(std::vector<IVec2> {IVec2(2, 1)}, Rotate90 | FlipY, false);
-	// Rook definition
-	UnitMovePiece rook = UnitMovePiece(4, false, false, RookSprite);
-	rook.generateMoveset(std::vector<IVec2> {IVec2(1, 0)}, Rotate90, true);
-	// Queen definition
-	UnitMovePiece queen = UnitMovePiece(5, false, false, QueenSprite);
-	queen.generateMoveset(std::vector<IVec2> {IVec2(1, 0)}, Rotate45, true);
-	// King definition
-	King king = King(6, 4, KingSprite);
-	// Create vector of PieceDef pointers
-	std::vector<PieceDef*> pieces
-	{
-		&pawn,
-		&bishop,
-		&knight,
-		&rook,
-		&queen,
-		&king
-	};
-	// Initialize board state with initital chess position
-	BoardState board = BoardState(new byte[64]
-	{
-		0x04, 0x03, 0x02, 0x05, 0x06, 0x02, 0x03, 0x04,
-		0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01,
-		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-		0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
-		0x14, 0x13, 0x12, 0x15, 0x16, 0x12, 0x13, 0x14
-	});
-	// Create ChessGame object based on pieces and board, and start its main loop
-	ChessGame game = ChessGame(pieces, board);
+	// Standard chess piece definitions (see StandardPieces.h for how pieces are defined)
+	StandardPieces pieces;
+	// The AI evaluates with the network if a weights file is next to the game, classically otherwise
+	nnue().load(NNUE_DEFAULT_FILE);
+	// Endgame tables generated by TbGen are probed from the "tb" folder when present
+	tablebases().setPath(TB_DEFAULT_PATH);
+	// The AI plays the moves of the opening book next to the game, if there is one
+	book().open(BOOK_DEFAULT_FILE);
+	// Create ChessGame object based on pieces and the initial chess position, and start its main loop
+	ChessGame game(pieces.list(), StandardPieces::startingBoard());
 	game.mainloop();
 }
\ No newline at end of file
@@ -0,0 +1,18 @@
+#pragma once
+#include "Platform.h"
+#include "Position.h"
+
+// Game phase of the standard starting position, positions above it count as middle game
+#define PHASE_MAX 22
+
+// Static evaluation of a position in centipawns, from the point of view of the team to
+// move. The material and piece-square scores are summed incrementally by the board (see
+// PieceSquareTables), so this only blends the middle game and end game scores by the
+// game phase, from the PieceDef values and tables of any piece set.
+inline int evaluate(const Position& pos)
+{
+	const BoardState& board = pos.board;
+	int phase = board.phase < PHASE_MAX ? board.phase : PHASE_MAX;
+	int score = (board.psqMg * phase + board.psqEg * (PHASE_MAX - phase)) / PHASE_MAX;
+	return pos.currTeam == 1 ? score : -score;
+}
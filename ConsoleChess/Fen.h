@@ -0,0 +1,95 @@
+#pragma once
+#include <string>
+#include <cctype>
+
+#include "Platform.h"
+#include "BoardState.h"
+
+// Piece letters of the standard piece set (see StandardPieces), indexed by piece ID - 1.
+// Black pieces are lowercase and white pieces uppercase, like in FEN.
+#define STANDARD_PIECE_LETTERS "pbnrqk"
+
+// Get the name of a board index in algebraic notation (ex. e4). Row 0 is the 8th rank.
+inline std::string squareName(int pos)
+{
+	return std::string(1, (char)('a' + (pos & 7))) + (char)('8' - (pos >> 3));
+}
+
+// Get the board index of a square name (ex. e4), -1 if it isn't one.
+inline int parseSquare(const char* name)
+{
+	if (name[0] < 'a' || name[0] > 'h' || name[1] < '1' || name[1] > '8') { return -1; }
+	return ('8' - name[1]) << 3 | (name[0] - 'a');
+}
+
+// Parse a FEN string into a board and the team to move (1 for white).
+// The board has no move history, so the flags are derived from the FEN fields:
+//  - pawns have moved unless they are on their initial rank
+//  - kings (letter k) have moved unless their team has a castling right
+//  - rooks (letter r) have moved unless they are in a corner with a castling right
+//  - the pawn which can be captured en passant gets the temporary special flag
+// Returns false if the string is malformed or uses an unknown piece letter.
+inline bool loadFen(const std::string& fen, BoardState& board, byte& team, const char* letters = STANDARD_PIECE_LETTERS)
+{
+	std::string letterStr = std::string(letters);
+	size_t i = 0;
+	byte data[64] = { };
+	// Piece placement, from the 8th rank (row 0) to the 1st
+	int x = 0, y = 0;
+	for (; i < fen.size() && fen[i] != ' '; i++)
+	{
+		char c = fen[i];
+		if (c == '/') { x = 0; y++; continue; }
+		if (isdigit(c)) { x += c - '0'; continue; }
+		size_t id = letterStr.find((char)tolower(c));
+		if (id == std::string::npos || x > 7 || y > 7) { return false; }
+		data[y << 3 | x] = (byte)(id + 1) | (isupper(c) ? PIECE_TEAM : 0);
+		x++;
+	}
+	if (y != 7 || x != 8) { return false; }
+	// Fields after the board, missing ones use default values
+	std::string fields[3] = { "w", "-", "-" };
+	for (int f = 0; f < 3; f++)
+	{
+		while (i < fen.size() && fen[i] == ' ') { i++; }
+		size_t end = fen.find(' ', i);
+		if (end == std::string::npos) { end = fen.size(); }
+		if (end > i) { fields[f] = fen.substr(i, end - i); }
+		i = end;
+	}
+	if (fields[0] != "w" && fields[0] != "b") { return false; }
+	team = fields[0] == "w";
+	const std::string& castle = fields[1];
+	// Moved flags
+	for (int pos = 0; pos < 64; pos++)
+	{
+		if (data[pos] == 0) { continue; }
+		char c = letters[(data[pos] & PIECE_ID) - 1];
+		bool white = (data[pos] & PIECE_TEAM) != 0;
+		bool moved = false;
+		if (c == 'p') { moved = (pos >> 3) != (white ? 6 : 1); }
+		else if (c == 'k')
+		{
+			moved = castle.find(white ? 'K' : 'k') == std::string::npos &&
+				castle.find(white ? 'Q' : 'q') == std::string::npos;
+		}
+		else if (c == 'r')
+		{
+			char side = ((pos & 7) == 7) ? 'k' : ((pos & 7) == 0) ? 'q' : 0;
+			if (white) { side = (char)toupper(side); }
+			moved = side == 0 || (pos >> 3) != (white ? 7 : 0) || castle.find(side) == std::string::npos;
+		}
+		if (moved) { data[pos] |= PIECE_MOVED; }
+	}
+	// En passant target square, the pawn which just moved is in front of it
+	const std::string& ep = fields[2];
+	if (ep != "-")
+	{
+		if (ep.size() != 2 || ep[0] < 'a' || ep[0] > 'h' || ep[1] < '1' || ep[1] > '8') { return false; }
+		int pawnPos = ('8' - ep[1] + (team ? 1 : -1)) << 3 | (ep[0] - 'a');
+		if (pawnPos < 0 || pawnPos > 63) { return false; }
+		if (data[pawnPos] != 0) { data[pawnPos] |= PIECE_SPTEMP; }
+	}
+	board = BoardState(data);
+	return true;
+}
@@ -141,6 +141,13 @@ public:
 		ready = true;
 	}
 
+	// Check if input events are waiting to be read by eventTick
+	bool hasEvents()
+	{
+		DWORD nEvents = 0;
+		return GetNumberOfConsoleInputEvents(hConsoleIn, &nEvents) && nEvents > 0;
+	}
+
 	// Call every iteration of a main loop to trigger instance-defined event handlers
 	void eventTick()
 	{
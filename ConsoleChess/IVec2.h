@@ -1,5 +1,6 @@
 #pragma once
 #include <cmath>
+#include <cstdlib>
 
 /// int32 2D vector struct
 struct IVec2
@@ -8,8 +9,8 @@ struct IVec2
     int y; // Y corrdinate
  
 	// Default constructor (0) and x,y constructor
-	IVec2() : x(0), y(0) {};
-	IVec2(int x, int y) : x(x), y(y) {};
+	constexpr IVec2() : x(0), y(0) {};
+	constexpr IVec2(int x, int y) : x(x), y(y) {};
 
 	// Square of Euclidian distance
 	int lenSqr() const
@@ -158,12 +159,12 @@ struct IVec2
 // Right-side operator overloads with scalars need to be defined
 // out of the struct body.
 
-IVec2 operator*(int s, const IVec2& a)
+inline IVec2 operator*(int s, const IVec2& a)
 {
 	return a.operator*(s);
 }
 
-IVec2 operator/(int s, const IVec2& a)
+inline IVec2 operator/(int s, const IVec2& a)
 {
 	return a.operator/(s);
 }
\ No newline at end of file
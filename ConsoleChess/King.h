@@ -1,6 +1,7 @@
 #pragma once
 #include "PieceDef.h"
 #include "SpriteDefs.h"
+#include "Rays.h"
 
 // Subclass of PieceDef for a chess king
 class King : public PieceDef
@@ -9,9 +10,19 @@ public:
 	byte rookId; // Id of rook, required for castling
 
 	// Default king ctor
-	King(byte id, byte rookId, Byte88 sprite) : PieceDef(id, true, sprite) 
+	King(byte id, byte rookId, const Byte88& sprite) : PieceDef(id, true, sprite) 
 	{ 
 		this->rookId = rookId;
+		// Castling needs the moved flag
+		hashedFlags = PIECE_MOVED;
+		// Stay behind the pieces in the middle game, and go to the center in the end game
+		for (int i = 0; i < 64; i++)
+		{
+			int x = i & 7, rows = 7 - (i >> 3);
+			int dx = abs(2 * x - 7), dy = abs(2 * (i >> 3) - 7);
+			psqMg[i] = (short)(-15 * (rows < 4 ? rows : 4) + ((x == 1 || x == 2 || x == 6) ? 10 : 0));
+			psqEg[i] = (short)(-10 * ((dx > dy ? dx : dy) / 2));
+		}
 	}
 
 	// Check if potential king move is pseudolegal
@@ -24,16 +35,11 @@ public:
 		// Castle
 		if (!p.moved && abs(delta.x) == 2 && delta.y == 0)
 		{
-			IVec2 dir = IVec2((end.x > start.x) ? 1 : -1, 0);
 			IVec2 rookPos = IVec2((end.x > start.x) ? 7 : 0, start.y);
 			Piece rook = board.getPiece(rookPos);
 			// Rook is there and path is unobstructed
 			if (rook.id != rookId || rook.team != p.team) { return false; }
-			for (IVec2 sqr = start + dir; sqr != rookPos; sqr += dir)
-			{
-				if (board[sqr] != 0) { return false; }
-			}
-			return true;
+			return (BoardRays.between[POS_TO_INDEX(start)][POS_TO_INDEX(rookPos)] & board.occupied) == 0;
 		}
 		// Normal move case
 		if (board[end] == 0 || board.getPiece(end).team != p.team)
@@ -43,6 +49,68 @@ public:
 		return false;
 	}
 
+	// Get the bitboard of squares attacked by the king (the 3x3 square around it)
+	UINT64 attacks(IVec2 start, const BoardState &board) override
+	{
+		UINT64 att = 0;
+		for (int i = 0; i < 9; i++)
+		{
+			IVec2 end = start + IVec2(i % 3 - 1, i / 3 - 1);
+			if (end != start && end.in88Square()) att |= SQUARE_BB(POS_TO_INDEX(end));
+		}
+		return att;
+	}
+
+	// Kings attack the squares around them directly
+	bool attackPath(IVec2 start, IVec2 end, const BoardState &board, UINT64 &path) override
+	{
+		path = 0;
+		return start != end && abs(end.x - start.x) <= 1 && abs(end.y - start.y) <= 1;
+	}
+
+	// King attacks have no path
+	bool hasAttackPaths() override
+	{
+		return true;
+	}
+
+	// Get the bitboard of pseudolegal king targets
+	UINT64 targets(IVec2 start, const BoardState &board) override
+	{
+		Piece p = board.getPiece(start);
+		// Normal moves in the 3x3 square around self
+		UINT64 tgts = attacks(start, board) & ~board.teamBB[p.team];
+		// Castle
+		if (!p.moved)
+		{
+			for (int dir = -1; dir <= 1; dir += 2)
+			{
+				IVec2 end = start + IVec2(2 * dir, 0);
+				IVec2 rookPos = IVec2((dir > 0) ? 7 : 0, start.y);
+				Piece rook = board.getPiece(rookPos);
+				if (!end.in88Square() || rook.id != rookId || rook.team != p.team) { continue; }
+				// Rook is there, check if path is unobstructed
+				UINT64 path = BoardRays.between[POS_TO_INDEX(start)][POS_TO_INDEX(rookPos)];
+				if ((path & board.occupied) == 0) tgts |= SQUARE_BB(POS_TO_INDEX(end));
+			}
+		}
+		return tgts;
+	}
+
+	// Append the pseudolegal king moves to a move list, flagging castles
+	void generateMoves(IVec2 start, const BoardState &board, MoveList &moves) override
+	{
+		int from = POS_TO_INDEX(start);
+		UINT64 tgts = targets(start, board);
+		UINT64 enemies = board.teamBB[board.getPiece(from).team ^ 1];
+		while (tgts)
+		{
+			int to = popLsb(tgts);
+			if (abs((to & 7) - start.x) == 2) { moves.add(from, to, MoveCastle); }
+			else { moves.add(from, to, (enemies & SQUARE_BB(to)) ? MoveCapture : MoveQuiet); }
+		}
+	}
+
 	// Perform a king move. Return value represents promotion and is thus false.
 	bool makeMove(IVec2 start, IVec2 end, BoardState& board) override
 	{
@@ -53,8 +121,8 @@ public:
 		// Normal move
 		if (abs(delta.x) < 2)
 		{
-			board[end] = board[start] | PIECE_MOVED;
-			board[start] = 0;
+			board.set(end, board[start] | PIECE_MOVED);
+			board.set(start, 0);
 		}
 		// Castle
 		else
@@ -62,11 +130,11 @@ public:
 			IVec2 dir = IVec2((end.x > start.x) ? 1 : -1, 0);
 			IVec2 rookPos = IVec2((end.x > start.x) ? 7 : 0, start.y);
 			
-			board[start + 2 * dir] = board[start] | PIECE_MOVED;
-			board[start] = 0;
+			board.set(start + 2 * dir, board[start] | PIECE_MOVED);
+			board.set(start, 0);
 
-			board[start + dir] = board[rookPos] | PIECE_MOVED;
-			board[rookPos] = 0;
+			board.set(start + dir, board[rookPos] | PIECE_MOVED);
+			board.set(rookPos, 0);
 		}
 		return false;
 	}
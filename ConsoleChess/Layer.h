@@ -33,7 +33,7 @@ public:
 	Layer() : w(0), h(0), sz(0), buffer(NULL) {};
 
 	// Create layer from a Byte88
-	Layer(Byte88 b, IVec2 pos) : w(8), h(8), sz(64)
+	Layer(const Byte88& b, IVec2 pos) : w(8), h(8), sz(64)
 	{
 		buffer = (byte*)malloc(64);
 		memcpy_s(buffer, sz, b.data, sz);
@@ -0,0 +1,150 @@
+#pragma once
+#include "Platform.h"
+#include "BoardState.h"
+#include "PieceDef.h"
+#include "AttackMap.h"
+#include "PieceSet.h"
+#include "MoveList.h"
+#include "Bitboard.h"
+
+// Legality filter for the moves of a team, computed once per position.
+// Finds the checkers, the pinned pieces with their pin rays and the squares the
+// critical piece may not enter, so that the legality of a pseudolegal move is
+// a few mask operations instead of making the move and looking for checks.
+// Only usable when the team has at most one critical piece and every piece
+// on the board describes its attack paths (see PieceDef::hasAttackPaths).
+struct Legality
+{
+	bool usable;		// False if moves must be checked by making them
+	int team;			// Team the filter was computed for
+	int crit;			// Square of the critical piece, -1 if none
+	UINT64 checkers;	// Enemy pieces attacking the critical piece
+	UINT64 checkMask;	// Squares non-critical moves must end on (capture or block the check)
+	UINT64 pinned;		// Pieces which can't leave the line to the critical piece
+	UINT64 pinRays[64];	// Squares each pinned piece is allowed to move to
+	UINT64 danger;		// Squares attacked by the enemy once the critical piece leaves its square
+
+	PieceDef** defs;		// Piece definitions
+	const BoardState* board;// Board the filter was computed for
+
+	// Create unusable legality filter.
+	Legality() : usable(false), team(0), crit(-1), checkers(0), checkMask(0), pinned(0), danger(0),
+		defs(NULL), board(NULL) {};
+
+	// Compute the filter for the moves of a team. The attack map must match the board.
+	template<typename Set = DynamicPieceSet>
+	void compute(const BoardState& board, PieceDef** defs, const AttackMap& attackMap, int team)
+	{
+		this->board = &board;
+		this->defs = defs;
+		this->team = team;
+		usable = false;
+		crit = -1;
+		checkers = pinned = danger = 0;
+		checkMask = ~0ULL;
+		// Find the critical piece and check if every piece has attack paths
+		UINT64 crits = 0;
+		for (int id = 1; id < 16; id++)
+		{
+			if ((board.pieceBB[0][id] | board.pieceBB[1][id]) == 0) { continue; }
+			if (!defs[id]->hasAttackPaths()) { return; }
+			if (defs[id]->critical) { crits |= board.pieceBB[team][id]; }
+		}
+		if (popCount(crits) > 1) { return; }
+		usable = true;
+		if (crits == 0) { return; } // Nothing to protect, every move is legal
+		crit = bitScan(crits);
+		IVec2 critPos = IVec2(crit & 7, crit >> 3);
+
+		// Enemy pieces with an empty path give check, with one friendly piece on it they pin it
+		UINT64 enemies = board.teamBB[team ^ 1];
+		while (enemies)
+		{
+			int i = popLsb(enemies);
+			UINT64 path;
+			if (!Set::attackPath(defs, board[i], IVec2(i & 7, i >> 3), critPos, board, path)) { continue; }
+			UINT64 blockers = path & board.occupied;
+			if (blockers == 0)
+			{	// Check, other moves must capture the checker or block its path. Fairy
+				// pieces may have crossing paths, so one move can block several checks.
+				checkMask &= path | SQUARE_BB(i);
+				checkers |= SQUARE_BB(i);
+			}
+			else if ((blockers & (blockers - 1)) == 0 && (blockers & board.teamBB[team]))
+			{	// Pinned piece, can only move on the path or capture the pinning piece
+				int p = bitScan(blockers);
+				if ((pinned & blockers) == 0) { pinRays[p] = ~0ULL; }
+				pinned |= blockers;
+				pinRays[p] &= path | SQUARE_BB(i);
+			}
+		}
+
+		// Squares attacked by the enemy. Pieces giving check may see further once the
+		// critical piece moved away, so recompute them without it.
+		UINT64 src = attackMap.sources & board.teamBB[team ^ 1] & ~checkers;
+		while (src) { danger |= attackMap.attacksFrom[popLsb(src)]; }
+		if (checkers)
+		{
+			BoardState without = BoardState(board);
+			without.set(crit, 0);
+			UINT64 chk = checkers;
+			while (chk)
+			{
+				int i = popLsb(chk);
+				danger |= Set::attacks(defs, board[i], IVec2(i & 7, i >> 3), without);
+			}
+		}
+	}
+
+	// Check if a square is attacked by the enemy with a different occupancy, ignoring
+	// the pieces in exclude. Used for moves which change more than two squares.
+	bool attackedWith(int sqr, UINT64 occ, UINT64 exclude) const
+	{
+		IVec2 pos = IVec2(sqr & 7, sqr >> 3);
+		UINT64 enemies = board->teamBB[team ^ 1] & ~exclude;
+		while (enemies)
+		{
+			int i = popLsb(enemies);
+			UINT64 path;
+			if (defs[(*board)[i] & PIECE_ID]->attackPath(IVec2(i & 7, i >> 3), pos, *board, path) && (path & occ) == 0)
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	// Check if a pseudolegal move leaves the critical piece safe. Filter must be usable.
+	bool isLegal(const Move& move) const
+	{
+		if (crit < 0) { return true; }
+		UINT64 to = SQUARE_BB(move.to());
+		if (move.flags() & MoveCastle)
+		{	// Castle, the king (see King::makeMove) jumps two squares and the rook lands in between.
+			// Attacked squares the king passes through do not matter, only its final square.
+			int dir = (move.to() > move.from()) ? 1 : -1;
+			int rookPos = (move.from() & ~7) | ((dir > 0) ? 7 : 0);
+			int kingDest = move.to(), rookDest = move.from() + dir;
+			UINT64 occ = board->occupied & ~SQUARE_BB(move.from()) & ~SQUARE_BB(rookPos);
+			if (kingDest == rookPos)
+			{	// The king lands on the rook square, King::makeMove leaves it next to its start
+				kingDest = rookDest;
+				occ |= SQUARE_BB(rookDest);
+			}
+			else { occ |= SQUARE_BB(kingDest) | SQUARE_BB(rookDest); }
+			int after = (crit == move.from()) ? kingDest : (crit == rookPos) ? rookDest : crit;
+			return !attackedWith(after, occ, 0);
+		}
+		if (move.flags() & MoveEnPassant)
+		{	// En passant, the captured pawn may have been the only piece blocking a check
+			int cap = (move.from() & ~7) | (move.to() & 7);
+			UINT64 occ = (board->occupied & ~SQUARE_BB(move.from()) & ~SQUARE_BB(cap)) | to;
+			int after = (crit == move.from()) ? move.to() : crit;
+			return !attackedWith(after, occ, SQUARE_BB(cap));
+		}
+		if (move.from() == crit) { return (danger & to) == 0; }
+		if ((checkMask & to) == 0) { return false; }
+		if (pinned & SQUARE_BB(move.from())) { return (pinRays[move.from()] & to) != 0; }
+		return true;
+	}
+};
@@ -0,0 +1,98 @@
+#pragma once
+#include <string>
+
+#include "Platform.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Read only view of a whole file mapped in memory. The system pages the file in as it is
+// read, so large data files (see Tablebase and Book) are usable as soon as they are opened,
+// without reading or parsing them.
+class MappedFile
+{
+	const byte* view;	// Start of the file, NULL if no file is mapped
+	size_t bytes;		// Size of the file
+#ifdef _WIN32
+	HANDLE file, map;	// Mapped file handles
+#endif
+
+public:
+	MappedFile() : view(NULL), bytes(0)
+#ifdef _WIN32
+		, file(INVALID_HANDLE_VALUE), map(NULL)
+#endif
+	{ }
+
+	~MappedFile()
+	{
+		close();
+	}
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	// Map a file, closing the previous one. Returns false if it is missing or empty.
+	bool open(const std::string& path)
+	{
+		close();
+		void* v = NULL;
+#ifdef _WIN32
+		file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+		if (file == INVALID_HANDLE_VALUE) { return false; }
+		LARGE_INTEGER fileSize;
+		if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0)
+		{
+			map = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+			bytes = (size_t)fileSize.QuadPart;
+		}
+		if (map != NULL) { v = MapViewOfFile(map, FILE_MAP_READ, 0, 0, 0); }
+#else
+		int fd = ::open(path.c_str(), O_RDONLY);
+		if (fd < 0) { return false; }
+		struct stat st;
+		if (fstat(fd, &st) == 0 && st.st_size > 0)
+		{
+			bytes = (size_t)st.st_size;
+			v = mmap(NULL, bytes, PROT_READ, MAP_SHARED, fd, 0);
+			if (v == MAP_FAILED) { v = NULL; }
+		}
+		::close(fd); // The mapping stays valid
+#endif
+		view = (const byte*)v;
+		if (view == NULL) { close(); }
+		return view != NULL;
+	}
+
+	// Unmap the file
+	void close()
+	{
+#ifdef _WIN32
+		if (view != NULL) { UnmapViewOfFile(view); }
+		if (map != NULL) { CloseHandle(map); }
+		if (file != INVALID_HANDLE_VALUE) { CloseHandle(file); }
+		file = INVALID_HANDLE_VALUE;
+		map = NULL;
+#else
+		if (view != NULL) { munmap((void*)view, bytes); }
+#endif
+		view = NULL;
+		bytes = 0;
+	}
+
+	// Start of the file, NULL if none is mapped
+	const byte* data() const
+	{
+		return view;
+	}
+
+	// Size of the file in bytes
+	size_t size() const
+	{
+		return bytes;
+	}
+};
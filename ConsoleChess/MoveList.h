@@ -0,0 +1,199 @@
+#pragma once
+#include <memory>
+#include <stdexcept>
+
+#include "Platform.h"
+#include "IVec2.h"
+
+// Maximum amount of moves held by a MoveList. Legal chess positions never
+// have more than 218 moves.
+#define MAX_MOVES 256
+
+#define MOVE_ARENA_SIZE (1 << 18) // Bytes of move list memory of each thread
+
+// Flags describing the kind of a generated move. They fit in the 4 bits Move keeps for them.
+enum MoveFlags : byte
+{
+	MoveQuiet =			0b0000,
+	MoveCapture =		0b0001,
+	MoveEnPassant =		0b0010,
+	MoveCastle =		0b0100,
+	MovePromotion =		0b1000
+};
+
+// Kinds of moves, to generate only some of them
+enum MoveKinds
+{
+	MovesNoisy = 1,	// Captures and promotions
+	MovesQuiet = 2,	// Every other move
+	MovesAll = 3
+};
+
+// Check if move flags are those of a noisy move (capture or promotion)
+inline bool isNoisy(byte flags)
+{
+	return (flags & (MoveCapture | MovePromotion)) != 0;
+}
+
+// A move of the piece on a square to another, packed in 16 bits: the index of the start
+// square (bits 0-5), the index of the end square (bits 6-11) and the MoveFlags (bits 12-15).
+struct Move
+{
+	UINT16 data; // Packed move
+
+	// Create empty move
+	Move() : data(0) {};
+	Move(int from, int to, int flags) : data((UINT16)(from | to << 6 | flags << 12)) {};
+
+	// Index of the start square
+	int from() const
+	{
+		return data & 63;
+	}
+
+	// Index of the end square
+	int to() const
+	{
+		return data >> 6 & 63;
+	}
+
+	// MoveFlags of the move
+	byte flags() const
+	{
+		return (byte)(data >> 12);
+	}
+
+	// Get the start square as a vector
+	IVec2 start() const
+	{
+		return IVec2(from() & 7, from() >> 3);
+	}
+
+	// Get the end square as a vector
+	IVec2 end() const
+	{
+		return IVec2(to() & 7, to() >> 3);
+	}
+};
+
+// Stack of memory for the move lists of a thread (see moveArena). Memory is taken from the
+// top and given back in the reverse order, so lists cost nothing to create, use only the
+// room of the moves they hold, and the search and perft never touch the heap.
+class MoveArena
+{
+private:
+	std::unique_ptr<byte[]> buffer;	// Memory of the arena
+	size_t top;						// Bytes in use
+
+public:
+	size_t peak; // Most bytes ever in use, for benchmarks
+
+	// Create arena of MOVE_ARENA_SIZE bytes
+	MoveArena() : buffer(new byte[MOVE_ARENA_SIZE]), top(0), peak(0) {};
+
+	// Holds the memory of live lists, so it can't be copied
+	MoveArena(const MoveArena&) = delete;
+	MoveArena& operator=(const MoveArena&) = delete;
+
+	// Get the bytes in use, to give them back later with release
+	size_t mark() const
+	{
+		return top;
+	}
+
+	// Give back the memory taken since a mark
+	void release(size_t mark)
+	{
+		top = mark;
+	}
+
+	// Get the mark of an address in the arena
+	size_t markOf(const void* p) const
+	{
+		return (const byte*)p - buffer.get();
+	}
+
+	// Get the aligned address the next allocation of a type starts at
+	template<typename T> T* next()
+	{
+		return (T*)(buffer.get() + ((top + alignof(T) - 1) & ~(alignof(T) - 1)));
+	}
+
+	// Take memory for count objects of a type. Returns NULL if the arena is full.
+	template<typename T> T* alloc(size_t count)
+	{
+		size_t start = (top + alignof(T) - 1) & ~(alignof(T) - 1);
+		if (start + count * sizeof(T) > MOVE_ARENA_SIZE) { return NULL; }
+		top = start + count * sizeof(T);
+		if (top > peak) { peak = top; }
+		return (T*)(buffer.get() + start);
+	}
+};
+
+// Get the move arena of the calling thread
+inline MoveArena& moveArena()
+{
+	thread_local MoveArena arena;
+	return arena;
+}
+
+// List of moves on the move arena of the thread, meant to be a local variable. Lists free
+// their memory in the reverse order they were created in, and only the last list created
+// can grow (add moves to it).
+class MoveList
+{
+private:
+	MoveArena& arena;	// Arena holding the moves
+	size_t base;		// Arena mark before the list
+
+public:
+	Move* moves;		// Moves of the list
+	int size;			// Amount of moves in the list
+
+	// Create empty move list at the top of the thread's arena
+	MoveList() : arena(moveArena()), base(arena.mark()), moves(arena.next<Move>()), size(0) {};
+
+	~MoveList()
+	{
+		arena.release(base);
+	}
+
+	// Lives on the arena, so it can't be copied
+	MoveList(const MoveList&) = delete;
+	MoveList& operator=(const MoveList&) = delete;
+
+	// Append a move to the list. Throws if the list is full (MAX_MOVES moves or no room
+	// left in the arena), or if it isn't the last list created.
+	void add(int from, int to, byte flags)
+	{
+		if (size >= MAX_MOVES) { throw std::length_error("Move list holds more than MAX_MOVES moves"); }
+		Move* m = arena.alloc<Move>(1);
+		if (m == NULL) { throw std::length_error("Move arena is full"); }
+		if (m != moves + size) { throw std::logic_error("Only the last move list created can grow"); }
+		*m = Move(from, to, flags);
+		size++;
+	}
+
+	// Keep only the first moves of the list, giving back the memory of the others.
+	void truncate(int count)
+	{
+		size = count;
+		arena.release(arena.markOf(moves + size));
+	}
+
+	// Remove all moves from the list.
+	void clear()
+	{
+		truncate(0);
+	}
+
+	Move& operator[](int index)
+	{
+		return moves[index];
+	}
+
+	const Move& operator[](int index) const
+	{
+		return moves[index];
+	}
+};
@@ -0,0 +1,328 @@
+#pragma once
+#include <algorithm>
+#include <cstdlib>
+#include <stdexcept>
+
+#include "Platform.h"
+#include "Position.h"
+#include "MoveList.h"
+#include "Legality.h"
+
+#define MAX_PLY 64			// Maximum depth of the search tree, quiescence included
+#define HISTORY_MAX 16384	// Bound of the history scores
+
+// The pickers of a line of the search (one per ply) fit in the move arena even when each
+// one holds MAX_MOVES moves with their scores and promotions, so a full arena is a bug
+static_assert(MAX_PLY * (MAX_MOVES * (sizeof(Move) + sizeof(int) + sizeof(byte)) + 2 * sizeof(int)) <= MOVE_ARENA_SIZE,
+	"The move arena can't hold the move pickers of MAX_PLY plies");
+
+// A move picked by the search, with the piece it promotes to
+struct SearchMove
+{
+	byte from;		// Index of the start square
+	byte to;		// Index of the end square
+	byte promotion;	// ID of the piece to promote to, 0 if the move doesn't promote
+	byte flags;		// MoveFlags of the move, not part of comparisons and packing
+
+	// Get the start square as a vector
+	IVec2 start() const
+	{
+		return IVec2(from & 7, from >> 3);
+	}
+
+	// Get the end square as a vector
+	IVec2 end() const
+	{
+		return IVec2(to & 7, to >> 3);
+	}
+
+	// True for the empty move (no move found)
+	bool isNull() const
+	{
+		return from == to;
+	}
+
+	bool operator==(const SearchMove& m) const
+	{
+		return from == m.from && to == m.to && promotion == m.promotion;
+	}
+
+	// Pack the move in 16 bits, 0 is the null move
+	UINT64 pack() const
+	{
+		return (UINT64)from | (UINT64)to << 6 | (UINT64)(promotion & 0xF) << 12;
+	}
+
+	// Unpack a move packed with pack(), without its flags
+	static SearchMove unpack(UINT64 v)
+	{
+		return SearchMove{ (byte)(v & 63), (byte)(v >> 6 & 63), (byte)(v >> 12 & 0xF), 0 };
+	}
+};
+
+// Tables of the quiet moves which caused cutoffs in a search, used to order the quiet
+// moves of other nodes. Each search thread has its own.
+struct MoveHistory
+{
+	SearchMove killers[MAX_PLY + 1][2];	// Last two quiet moves which caused a cutoff at each ply
+	int butterfly[2][64][64];			// Score of each quiet move of each team by start and end square
+	SearchMove counters[32][64];		// Quiet reply which refuted each piece (team and ID) moving to each square
+
+	// Create empty tables
+	MoveHistory()
+	{
+		clear();
+	}
+
+	// Forget everything
+	void clear()
+	{
+		std::fill_n(&killers[0][0], (MAX_PLY + 1) * 2, SearchMove{ });
+		std::fill_n(&butterfly[0][0][0], 2 * 64 * 64, 0);
+		std::fill_n(&counters[0][0], 32 * 64, SearchMove{ });
+	}
+
+	// Prepare for a new search: killers are forgotten and the history fades
+	void age()
+	{
+		std::fill_n(&killers[0][0], (MAX_PLY + 1) * 2, SearchMove{ });
+		for (int i = 0; i < 2 * 64 * 64; i++) { (&butterfly[0][0][0])[i] /= 2; }
+	}
+
+	// Record a quiet move which caused a cutoff at a ply, after the previous move moved a
+	// piece (team and ID) to a square (prevPiece 0 if there is no previous move). The quiet
+	// moves tried before it lose score.
+	void update(int team, int ply, const SearchMove& move, int prevPiece, int prevTo, const SearchMove* tried, int nTried, int depth)
+	{
+		if (!(killers[ply][0] == move))
+		{
+			killers[ply][1] = killers[ply][0];
+			killers[ply][0] = move;
+		}
+		if (prevPiece != 0) { counters[prevPiece & 0x1F][prevTo] = move; }
+		int bonus = (depth < 34) ? depth * depth : 1200;
+		addHistory(team, move, bonus);
+		for (int i = 0; i < nTried; i++) { addHistory(team, tried[i], -bonus); }
+	}
+
+private:
+	// Move a history score toward +-HISTORY_MAX, less the closer it gets
+	void addHistory(int team, const SearchMove& move, int bonus)
+	{
+		int& h = butterfly[team][move.from][move.to];
+		h += bonus - h * abs(bonus) / HISTORY_MAX;
+	}
+};
+
+// Stages of the MovePicker, in order
+enum PickStage
+{
+	StageHash,		// Move from the transposition table
+	StageGenNoisy,	// Generate the captures and promotions
+	StageNoisy,		// Captures and promotions, by MVV-LVA
+	StageKillers,	// Killer moves of the ply
+	StageGenQuiet,	// Generate the quiet moves
+	StageQuiet,		// Quiet moves, by history and countermove
+	StageDone
+};
+
+// Gives the legal moves of a position one at a time, best first, for the search.
+// The hash move comes first, then the captures and promotions ordered by MVV-LVA (most
+// valuable victim, then least valuable attacker, using the PieceDef values), then the
+// killer moves, then the quiet moves ordered by history with a bonus for the countermove.
+// Each group of moves is only generated when it is reached, so a cutoff on an early move
+// skips generating the quiet moves. Promotions give one move per piece to promote to.
+// The moves and their scores live on the thread's move arena (see MoveArena), so pickers
+// must be destroyed in the reverse order they were created in, like move lists.
+class MovePicker
+{
+private:
+	Position& pos;					// Position to pick the moves of
+	const MoveHistory* history;		// Tables of the search, or NULL
+	SearchMove hashMove;			// Move to try first, may be illegal
+	SearchMove killers[2];			// Killer moves of the ply, may be illegal
+	SearchMove counter;				// Countermove of the previous move, may be illegal
+	bool noisyOnly;					// True to only pick captures and promotions
+	int stage;						// Current PickStage
+	int killerIndex;				// Next killer to try
+
+	Legality legality;				// Legality filter of the position
+	bool legalityReady;				// True once legality was computed
+
+	MoveList list;					// Moves of the current stage
+	int* scores;					// Ordering score of each move, on the arena after the list
+	byte* promotions;				// Piece to promote to of each move, 0 if it doesn't promote
+	int index;						// Next move of the current stage
+
+	// Get the legality filter of the position, computed on first use
+	const Legality& getLegality()
+	{
+		if (!legalityReady)
+		{
+			pos.computeLegality(legality, pos.currTeam);
+			legalityReady = true;
+		}
+		return legality;
+	}
+
+	// Check if a move remembered from another position is legal here, and fill in its flags
+	bool isLegal(SearchMove& m)
+	{
+		if (m.isNull()) { return false; }
+		Move move;
+		if (!pos.findLegalMove(pos.currTeam, m.from, m.to, move, getLegality())) { return false; }
+		m.flags = move.flags();
+		if (move.flags() & MovePromotion) { return m.promotion != 0 && pos.canPromote(m.start(), m.promotion); }
+		return m.promotion == 0;
+	}
+
+	// Value of the piece on a square, or of the piece moving there for en passant
+	int victimValue(const Move& m)
+	{
+		byte victim = pos.board[m.to()] ? pos.board[m.to()] : pos.board[m.from()];
+		PieceDef* def = pos.pieceDefs[victim & PIECE_ID];
+		return def != NULL ? def->value : 0;
+	}
+
+	// Generate the moves of a kind and score them. Promoting moves are repeated at the end
+	// of the list for every piece they can promote to after the first.
+	void generate(int kind)
+	{
+		list.clear();
+		index = 0;
+		int n = pos.generateLegalMoves(pos.currTeam, list, kind, getLegality());
+		for (int i = 0; i < n; i++)
+		{
+			if (!(list[i].flags() & MovePromotion)) { continue; }
+			for (int id = 0, first = 1; id < 16; id++)
+			{
+				if (!pos.canPromote(list[i].start(), id)) { continue; }
+				if (!first) { list.add(list[i].from(), list[i].to(), list[i].flags()); }
+				first = 0;
+			}
+		}
+		MoveArena& arena = moveArena();
+		scores = arena.alloc<int>(list.size);
+		promotions = arena.alloc<byte>(list.size);
+		if (scores == NULL || promotions == NULL) { throw std::length_error("Move arena is full"); }
+		// Pieces to promote to, the repeated moves follow the originals in order
+		for (int i = 0, j = n; i < n; i++)
+		{
+			promotions[i] = 0;
+			if (!(list[i].flags() & MovePromotion)) { continue; }
+			for (int id = 0, first = 1; id < 16; id++)
+			{
+				if (!pos.canPromote(list[i].start(), id)) { continue; }
+				if (first) { promotions[i] = (byte)id; }
+				else if (j < list.size) { promotions[j++] = (byte)id; }
+				first = 0;
+			}
+		}
+		for (int i = 0; i < list.size; i++)
+		{
+			const Move& m = list[i];
+			int score = 0;
+			if (kind == MovesNoisy)
+			{	// MVV-LVA, the victim outweighs the attacker
+				PieceDef* attacker = pos.pieceDefs[pos.board[m.from()] & PIECE_ID];
+				if (m.flags() & MoveCapture) { score = 16 * victimValue(m) - attacker->value; }
+			}
+			else
+			{
+				if (history != NULL) { score = history->butterfly[pos.currTeam][m.from()][m.to()]; }
+				if (m.from() == counter.from && m.to() == counter.to) { score += HISTORY_MAX; }
+			}
+			scores[i] = score + (promotions[i] != 0 ? pos.pieceDefs[promotions[i]]->value : 0);
+		}
+	}
+
+	// Take the best scored of the remaining moves of the stage. Moves already picked in an
+	// earlier stage are skipped.
+	bool pickBest(SearchMove& out)
+	{
+		while (index < list.size)
+		{
+			int best = index;
+			for (int j = index + 1; j < list.size; j++)
+			{
+				if (scores[j] > scores[best]) { best = j; }
+			}
+			std::swap(list[index], list[best]);
+			std::swap(scores[index], scores[best]);
+			std::swap(promotions[index], promotions[best]);
+			const Move& m = list[index];
+			out = SearchMove{ (byte)m.from(), (byte)m.to(), promotions[index], m.flags() };
+			index++;
+			if (out == hashMove || (!noisyOnly && !isNoisy(out.flags) && (out == killers[0] || out == killers[1]))) { continue; }
+			return true;
+		}
+		return false;
+	}
+
+public:
+	// Create picker for a position at a ply of the search. The hash move, the killers of the
+	// history and the countermove are tried if they are legal. With noisyOnly, only captures
+	// and promotions are picked (and no killers).
+	MovePicker(Position& pos, SearchMove hashMove, const MoveHistory* history = NULL, int ply = 0,
+		SearchMove counter = SearchMove{ }, bool noisyOnly = false) :
+		pos(pos), history(history), hashMove(hashMove), killers{ }, counter(counter), noisyOnly(noisyOnly),
+		stage(StageHash), killerIndex(0), legalityReady(false), list(), scores(NULL), promotions(NULL), index(0)
+	{
+		if (history != NULL && !noisyOnly)
+		{
+			killers[0] = history->killers[ply][0];
+			killers[1] = history->killers[ply][1];
+		}
+	}
+
+	// Get the next move. Returns false when every move was picked.
+	bool next(SearchMove& move)
+	{
+		while (true)
+		{
+			switch (stage)
+			{
+			case StageHash:
+				stage = StageGenNoisy;
+				if (isLegal(hashMove) && (!noisyOnly || isNoisy(hashMove.flags)))
+				{
+					move = hashMove;
+					return true;
+				}
+				hashMove = SearchMove{ }; // Don't skip an illegal hash move later on
+				break;
+			case StageGenNoisy:
+				generate(MovesNoisy);
+				stage = StageNoisy;
+				break;
+			case StageNoisy:
+				if (pickBest(move)) { return true; }
+				stage = noisyOnly ? StageDone : StageKillers;
+				break;
+			case StageKillers:
+				while (killerIndex < 2)
+				{
+					SearchMove& k = killers[killerIndex++];
+					if (!(k == hashMove) && isLegal(k) && !isNoisy(k.flags))
+					{
+						move = k;
+						return true;
+					}
+					k = SearchMove{ }; // Illegal here, don't skip it later on
+				}
+				stage = StageGenQuiet;
+				break;
+			case StageGenQuiet:
+				generate(MovesQuiet);
+				stage = StageQuiet;
+				break;
+			case StageQuiet:
+				if (pickBest(move)) { return true; }
+				stage = StageDone;
+				break;
+			default:
+				return false;
+			}
+		}
+	}
+};
@@ -0,0 +1,378 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <vector>
+
+#include "Platform.h"
+#include "BoardState.h"
+
+// The SIMD kernels use AVX2 when the compiler targets it (/arch:AVX2 or -mavx2), SSE2
+// otherwise on x86. Define NNUE_SCALAR to build the scalar reference kernels only.
+#if !defined(NNUE_SCALAR) && defined(__AVX2__)
+#define NNUE_AVX2
+#include <immintrin.h>
+#elif !defined(NNUE_SCALAR) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define NNUE_SSE2
+#include <emmintrin.h>
+#endif
+
+#define NNUE_FEATURES (32 * 64)	// Own or enemy piece ID on each square
+#define NNUE_HIDDEN 256			// Size of the accumulator of each team
+#define NNUE_L1 32				// Size of the first dense layer
+#define NNUE_L2 32				// Size of the second dense layer
+#define NNUE_SHIFT 6			// Right shift of the dense layer sums before clipping
+#define NNUE_OUTPUT_SCALE 16	// Output units per centipawn
+#define NNUE_VERSION 1			// Version of the weights file format
+#define NNUE_DEFAULT_FILE "nnue.bin"	// Weights file loaded by the game at startup
+
+// Feature transformer output of a position from the point of view of each team (the index
+// of the team). Updated incrementally from the squares a move changed, see Nnue::update.
+struct NnueAccumulator
+{
+	int16_t values[2][NNUE_HIDDEN];
+};
+
+// Efficiently updatable neural network evaluation. The input features are the pieces
+// (own or enemy, by ID) on each square, seen from both teams, black's squares being mirrored
+// vertically. Their weights are summed in an accumulator, which a move only changes by the
+// features of the squares it wrote (see BoardState::dirty), so castling, en passant and
+// promotions need nothing special. The accumulators of both teams, the side to move first,
+// go through small int8 dense layers with clipped ReLU activations to the score.
+//
+// Weights file layout, little-endian: "CCNN", version, NNUE_HIDDEN, NNUE_L1, NNUE_L2 (uint32),
+// then ftBias (int16 [HIDDEN]), ftWeights (int16 [FEATURES][HIDDEN]), l1Bias (int32 [L1]),
+// l1Weights (int8 [L1][2 * HIDDEN]), l2Bias (int32 [L2]), l2Weights (int8 [L2][L1]),
+// outBias (int32) and outWeights (int8 [L2]).
+class Nnue
+{
+private:
+	// Add (sign 1) or remove (sign -1) a row of feature weights to an accumulator
+	static void addRow(int16_t* acc, const int16_t* row, int sign)
+	{
+#if defined(NNUE_AVX2)
+		for (int i = 0; i < NNUE_HIDDEN; i += 16)
+		{
+			__m256i a = _mm256_loadu_si256((const __m256i*)(acc + i));
+			__m256i r = _mm256_loadu_si256((const __m256i*)(row + i));
+			a = sign > 0 ? _mm256_add_epi16(a, r) : _mm256_sub_epi16(a, r);
+			_mm256_storeu_si256((__m256i*)(acc + i), a);
+		}
+#elif defined(NNUE_SSE2)
+		for (int i = 0; i < NNUE_HIDDEN; i += 8)
+		{
+			__m128i a = _mm_loadu_si128((const __m128i*)(acc + i));
+			__m128i r = _mm_loadu_si128((const __m128i*)(row + i));
+			a = sign > 0 ? _mm_add_epi16(a, r) : _mm_sub_epi16(a, r);
+			_mm_storeu_si128((__m128i*)(acc + i), a);
+		}
+#else
+		addRowScalar(acc, row, sign);
+#endif
+	}
+
+	static void addRowScalar(int16_t* acc, const int16_t* row, int sign)
+	{
+		for (int i = 0; i < NNUE_HIDDEN; i++) { acc[i] = (int16_t)(acc[i] + sign * row[i]); }
+	}
+
+	// Clip an accumulator to [0, 127] as the bytes of the first layer input
+	static void clip(const int16_t* acc, uint8_t* out)
+	{
+#if defined(NNUE_AVX2)
+		const __m256i max = _mm256_set1_epi16(127);
+		for (int i = 0; i < NNUE_HIDDEN; i += 32)
+		{
+			__m256i a = _mm256_min_epi16(_mm256_loadu_si256((const __m256i*)(acc + i)), max);
+			__m256i b = _mm256_min_epi16(_mm256_loadu_si256((const __m256i*)(acc + i + 16)), max);
+			// Packing works on each 128 bit lane, put the quarters back in order
+			__m256i p = _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b), 0xD8);
+			_mm256_storeu_si256((__m256i*)(out + i), p);
+		}
+#elif defined(NNUE_SSE2)
+		const __m128i max = _mm_set1_epi16(127);
+		for (int i = 0; i < NNUE_HIDDEN; i += 16)
+		{
+			__m128i a = _mm_min_epi16(_mm_loadu_si128((const __m128i*)(acc + i)), max);
+			__m128i b = _mm_min_epi16(_mm_loadu_si128((const __m128i*)(acc + i + 8)), max);
+			_mm_storeu_si128((__m128i*)(out + i), _mm_packus_epi16(a, b));
+		}
+#else
+		clipScalar(acc, out);
+#endif
+	}
+
+	static void clipScalar(const int16_t* acc, uint8_t* out)
+	{
+		for (int i = 0; i < NNUE_HIDDEN; i++) { out[i] = (uint8_t)(acc[i] < 0 ? 0 : acc[i] > 127 ? 127 : acc[i]); }
+	}
+
+	// Dot products of n (a multiple of 32) clipped inputs with 4 consecutive rows of int8
+	// weights, the input being loaded once for the 4 rows. The products of two inputs fit in
+	// 16 bits, so the SIMD kernels give the same sums as the scalar one.
+	static void dot4(const uint8_t* in, const int8_t* w, int n, int32_t* out)
+	{
+#if defined(NNUE_AVX2)
+		const __m256i ones = _mm256_set1_epi16(1);
+		__m256i sum[4] = { _mm256_setzero_si256(), _mm256_setzero_si256(), _mm256_setzero_si256(), _mm256_setzero_si256() };
+		for (int i = 0; i < n; i += 32)
+		{
+			__m256i x = _mm256_loadu_si256((const __m256i*)(in + i));
+			for (int r = 0; r < 4; r++)
+			{
+				__m256i p = _mm256_maddubs_epi16(x, _mm256_loadu_si256((const __m256i*)(w + r * n + i)));
+				sum[r] = _mm256_add_epi32(sum[r], _mm256_madd_epi16(p, ones));
+			}
+		}
+		// Sum each row's lanes, the 4 results end up in one vector
+		__m256i s = _mm256_hadd_epi32(_mm256_hadd_epi32(sum[0], sum[1]), _mm256_hadd_epi32(sum[2], sum[3]));
+		__m128i r = _mm_add_epi32(_mm256_castsi256_si128(s), _mm256_extracti128_si256(s, 1));
+		_mm_storeu_si128((__m128i*)out, r);
+#elif defined(NNUE_SSE2)
+		// No unsigned by signed byte multiply in SSE2, widen both to 16 bits
+		const __m128i zero = _mm_setzero_si128();
+		__m128i sum[4] = { zero, zero, zero, zero };
+		for (int i = 0; i < n; i += 16)
+		{
+			__m128i x = _mm_loadu_si128((const __m128i*)(in + i));
+			__m128i lo = _mm_unpacklo_epi8(x, zero);
+			__m128i hi = _mm_unpackhi_epi8(x, zero);
+			for (int r = 0; r < 4; r++)
+			{
+				__m128i v = _mm_loadu_si128((const __m128i*)(w + r * n + i));
+				__m128i sign = _mm_cmplt_epi8(v, zero);
+				sum[r] = _mm_add_epi32(sum[r], _mm_madd_epi16(lo, _mm_unpacklo_epi8(v, sign)));
+				sum[r] = _mm_add_epi32(sum[r], _mm_madd_epi16(hi, _mm_unpackhi_epi8(v, sign)));
+			}
+		}
+		// Transpose and add so each row's lanes sum in one lane
+		__m128i a = _mm_add_epi32(_mm_unpacklo_epi32(sum[0], sum[1]), _mm_unpackhi_epi32(sum[0], sum[1]));
+		__m128i b = _mm_add_epi32(_mm_unpacklo_epi32(sum[2], sum[3]), _mm_unpackhi_epi32(sum[2], sum[3]));
+		_mm_storeu_si128((__m128i*)out, _mm_add_epi32(_mm_unpacklo_epi64(a, b), _mm_unpackhi_epi64(a, b)));
+#else
+		for (int r = 0; r < 4; r++) { out[r] = dotScalar(in, w + r * n, n); }
+#endif
+	}
+
+	static int32_t dotScalar(const uint8_t* in, const int8_t* w, int n)
+	{
+		int32_t sum = 0;
+		for (int i = 0; i < n; i++) { sum += in[i] * w[i]; }
+		return sum;
+	}
+
+	// Clipped ReLU of a dense layer sum
+	static uint8_t activate(int32_t sum)
+	{
+		sum >>= NNUE_SHIFT;
+		return (uint8_t)(sum < 0 ? 0 : sum > 127 ? 127 : sum);
+	}
+
+	// Dense layer of m (a multiple of 4) outputs over n inputs, with clipped ReLU
+	static void dense(const uint8_t* in, const int8_t* w, int n, const int32_t* bias, uint8_t* out, int m, bool scalar)
+	{
+		int32_t sums[4];
+		for (int i = 0; i < m; i += 4)
+		{
+			if (scalar)
+			{
+				for (int r = 0; r < 4; r++) { sums[r] = dotScalar(in, w + (i + r) * n, n); }
+			}
+			else { dot4(in, w + i * n, n, sums); }
+			for (int r = 0; r < 4; r++) { out[i + r] = activate(bias[i + r] + sums[r]); }
+		}
+	}
+
+	// Run the layers on an accumulator for the team to move, with or without SIMD
+	int propagate(const NnueAccumulator& acc, int team, bool scalar) const
+	{
+		uint8_t input[2 * NNUE_HIDDEN];
+		uint8_t l1[NNUE_L1];
+		uint8_t l2[NNUE_L2];
+		if (scalar)
+		{
+			clipScalar(acc.values[team], input);
+			clipScalar(acc.values[team ^ 1], input + NNUE_HIDDEN);
+		}
+		else
+		{
+			clip(acc.values[team], input);
+			clip(acc.values[team ^ 1], input + NNUE_HIDDEN);
+		}
+		dense(input, &l1Weights[0][0], 2 * NNUE_HIDDEN, l1Bias, l1, NNUE_L1, scalar);
+		dense(l1, &l2Weights[0][0], NNUE_L1, l2Bias, l2, NNUE_L2, scalar);
+		int32_t out = outBias + dotScalar(l2, outWeights, NNUE_L2); // A single row, too small for SIMD
+		return out / NNUE_OUTPUT_SCALE;
+	}
+
+	// Compute the accumulator of a board from scratch, with or without SIMD
+	void refreshWith(const BoardState& board, NnueAccumulator& acc, bool scalar) const
+	{
+		for (int team = 0; team < 2; team++)
+		{
+			memcpy(acc.values[team], ftBias, sizeof(ftBias));
+			UINT64 pieces = board.occupied;
+			while (pieces)
+			{
+				int i = popLsb(pieces);
+				const int16_t* row = &ftWeights[(size_t)feature(team, board[i], i) * NNUE_HIDDEN];
+				if (scalar) { addRowScalar(acc.values[team], row, 1); }
+				else { addRow(acc.values[team], row, 1); }
+			}
+		}
+	}
+
+	// Replace the features of the piece of a square before a move by the one after it
+	void updateSquare(NnueAccumulator& acc, int sqr, byte before, byte after) const
+	{
+		before &= PIECE_TEAM | PIECE_ID;
+		after &= PIECE_TEAM | PIECE_ID;
+		if (before == after) { return; } // Only flags changed
+		for (int team = 0; team < 2; team++)
+		{
+			if (before & PIECE_ID) { addRow(acc.values[team], &ftWeights[(size_t)feature(team, before, sqr) * NNUE_HIDDEN], -1); }
+			if (after & PIECE_ID) { addRow(acc.values[team], &ftWeights[(size_t)feature(team, after, sqr) * NNUE_HIDDEN], 1); }
+		}
+	}
+
+	// Read or write an array of the weights file
+	template<typename T> static bool read(std::ifstream& file, T* data, size_t count)
+	{
+		return (bool)file.read((char*)data, sizeof(T) * count);
+	}
+
+	template<typename T> static bool write(std::ofstream& file, const T* data, size_t count)
+	{
+		return (bool)file.write((const char*)data, sizeof(T) * count);
+	}
+
+public:
+	std::vector<int16_t> ftWeights;				// Feature transformer weights, [NNUE_FEATURES][NNUE_HIDDEN]
+	int16_t ftBias[NNUE_HIDDEN];				// Feature transformer biases
+	int8_t l1Weights[NNUE_L1][2 * NNUE_HIDDEN];	// First layer weights
+	int32_t l1Bias[NNUE_L1];					// First layer biases
+	int8_t l2Weights[NNUE_L2][NNUE_L1];			// Second layer weights
+	int32_t l2Bias[NNUE_L2];					// Second layer biases
+	int8_t outWeights[NNUE_L2];					// Output weights
+	int32_t outBias;							// Output bias
+	bool loaded;								// True once weights were loaded, the AI then uses the network
+
+	// Create network with zero weights, not loaded
+	Nnue() : ftWeights(NNUE_FEATURES * NNUE_HIDDEN, 0), ftBias{ }, l1Weights{ }, l1Bias{ }, l2Weights{ },
+		l2Bias{ }, outWeights{ }, outBias(0), loaded(false) {};
+
+	// Index of the feature of a board piece on a square, from the point of view of a team
+	static int feature(int team, byte piece, int sqr)
+	{
+		int own = ((piece & PIECE_TEAM) >> 4) == team ? 16 : 0;
+		return ((own | (piece & PIECE_ID)) << 6) | (team == 1 ? sqr : sqr ^ 56);
+	}
+
+	// Load the weights from a file. Returns false if the file is missing or doesn't match
+	// the network size, in which case the network is left unloaded.
+	bool load(const char* path)
+	{
+		loaded = false;
+		std::ifstream file(path, std::ios::binary);
+		char magic[4];
+		uint32_t header[4];
+		if (!read(file, magic, 4) || memcmp(magic, "CCNN", 4) != 0 || !read(file, header, 4)) { return false; }
+		if (header[0] != NNUE_VERSION || header[1] != NNUE_HIDDEN || header[2] != NNUE_L1 || header[3] != NNUE_L2) { return false; }
+		loaded = read(file, ftBias, NNUE_HIDDEN) && read(file, ftWeights.data(), ftWeights.size()) &&
+			read(file, l1Bias, NNUE_L1) && read(file, &l1Weights[0][0], NNUE_L1 * 2 * NNUE_HIDDEN) &&
+			read(file, l2Bias, NNUE_L2) && read(file, &l2Weights[0][0], NNUE_L2 * NNUE_L1) &&
+			read(file, &outBias, 1) && read(file, outWeights, NNUE_L2);
+		return loaded;
+	}
+
+	// Save the weights to a file. Returns false on failure.
+	bool save(const char* path) const
+	{
+		std::ofstream file(path, std::ios::binary);
+		uint32_t header[4] = { NNUE_VERSION, NNUE_HIDDEN, NNUE_L1, NNUE_L2 };
+		return write(file, "CCNN", 4) && write(file, header, 4) && write(file, ftBias, NNUE_HIDDEN) &&
+			write(file, ftWeights.data(), ftWeights.size()) && write(file, l1Bias, NNUE_L1) &&
+			write(file, &l1Weights[0][0], NNUE_L1 * 2 * NNUE_HIDDEN) && write(file, l2Bias, NNUE_L2) &&
+			write(file, &l2Weights[0][0], NNUE_L2 * NNUE_L1) && write(file, &outBias, 1) &&
+			write(file, outWeights, NNUE_L2);
+	}
+
+	// Fill the network with small random weights, to test and benchmark the kernels
+	void randomize(unsigned seed)
+	{
+		std::mt19937 rng(seed);
+		auto random = [&](int range) { return (int)(rng() % (2 * range + 1)) - range; };
+		for (auto& w : ftWeights) { w = (int16_t)random(8); }
+		for (int i = 0; i < NNUE_HIDDEN; i++) { ftBias[i] = (int16_t)random(32); }
+		for (int i = 0; i < NNUE_L1; i++)
+		{
+			l1Bias[i] = random(1024);
+			for (int j = 0; j < 2 * NNUE_HIDDEN; j++) { l1Weights[i][j] = (int8_t)random(16); }
+		}
+		for (int i = 0; i < NNUE_L2; i++)
+		{
+			l2Bias[i] = random(1024);
+			for (int j = 0; j < NNUE_L1; j++) { l2Weights[i][j] = (int8_t)random(64); }
+			outWeights[i] = (int8_t)random(127);
+		}
+		outBias = 0;
+		loaded = true;
+	}
+
+	// Compute the accumulator of a board from scratch
+	void refresh(const BoardState& board, NnueAccumulator& acc) const
+	{
+		refreshWith(board, acc, false);
+	}
+
+	// Same as refresh, with the scalar reference kernels
+	void refreshScalar(const BoardState& board, NnueAccumulator& acc) const
+	{
+		refreshWith(board, acc, true);
+	}
+
+	// Compute the accumulator of a board from the one of the board it was before a move,
+	// changing only the features of the squares the move wrote (board.dirty)
+	void update(const NnueAccumulator& prev, NnueAccumulator& acc, const BoardState& prevBoard, const BoardState& board) const
+	{
+		acc = prev;
+		UINT64 changed = board.dirty;
+		while (changed)
+		{
+			int i = popLsb(changed);
+			updateSquare(acc, i, prevBoard[i], board[i]);
+		}
+	}
+
+	// Same as update, with the bytes before the move taken from its undo record
+	void update(const NnueAccumulator& prev, NnueAccumulator& acc, const BoardState& board, const UndoRecord& undo) const
+	{
+		acc = prev;
+		UINT64 changed = undo.changed;
+		while (changed)
+		{
+			int i = popLsb(changed);
+			updateSquare(acc, i, undo.before(i, board[i]), board[i]);
+		}
+	}
+
+	// Score of an accumulator for the team to move, in centipawns
+	int evaluate(const NnueAccumulator& acc, int team) const
+	{
+		return propagate(acc, team, false);
+	}
+
+	// Same as evaluate, with the scalar reference kernels
+	int evaluateScalar(const NnueAccumulator& acc, int team) const
+	{
+		return propagate(acc, team, true);
+	}
+};
+
+// Get the global network, used by the AI once loaded
+inline Nnue& nnue()
+{
+	static Nnue network;
+	return network;
+}
@@ -7,7 +7,20 @@ class Pawn : public PieceDef
 {
 public:
 	// Default pawn ctor
-	Pawn(byte id, Byte88 sprite) : PieceDef(id, false, sprite) { }
+	Pawn(byte id, const Byte88& sprite) : PieceDef(id, false, sprite)
+	{
+		// Double push needs the moved flag, en passant the special temp flag
+		hashedFlags = PIECE_MOVED | PIECE_SPTEMP;
+		// Pawns never move back, their moves reset the halfmove clock
+		irreversible = true;
+		// Advance, the center files first in the middle game
+		for (int i = 0; i < 64; i++)
+		{
+			int x = i & 7, advance = (i >> 3) < 6 ? 6 - (i >> 3) : 0;
+			psqMg[i] = (short)(4 * advance + ((x == 3 || x == 4) && advance > 0 ? 10 : 0));
+			psqEg[i] = (short)(12 * advance);
+		}
+	}
 
 	// Check if potential pawn move is pseudolegal
 	bool isValidMove(IVec2 start, IVec2 end, const BoardState &board) override
@@ -39,6 +52,104 @@ public:
 		return false;
 	}
 
+	// Get the bitboard of pseudolegal pawn targets
+	UINT64 targets(IVec2 start, const BoardState &board) override
+	{
+		Piece p = board.getPiece(start);
+		int dir = p.team ? -1 : 1;
+		UINT64 tgts = 0;
+		// Blocked at end of board (should promote before this happens)
+		if (start.y == (p.team ? 0 : 7)) return 0;
+		// Push moves
+		IVec2 push = start + IVec2(0, dir);
+		if (board[push] == 0)
+		{
+			tgts |= SQUARE_BB(POS_TO_INDEX(push));
+			IVec2 dbl = push + IVec2(0, dir);
+			if (!p.moved && dbl.in88Square() && board[dbl] == 0) tgts |= SQUARE_BB(POS_TO_INDEX(dbl));
+		}
+		// Capture / en passant case
+		for (int i = -1; i <= 1; i += 2)
+		{
+			IVec2 end = start + IVec2(i, dir);
+			if (!end.in88Square()) continue;
+			// Normal capture
+			Piece cap = board.getPiece(end);
+			if (cap.team != p.team && cap.id != 0) tgts |= SQUARE_BB(POS_TO_INDEX(end));
+			// En passant
+			Piece enp = board.getPiece(start + IVec2(i, 0));
+			if (cap.id == 0 && enp.team != p.team && enp.id == id && enp.spTemp == 1) tgts |= SQUARE_BB(POS_TO_INDEX(end));
+		}
+		return tgts;
+	}
+
+	// Get the bitboard of squares attacked by the pawn (its diagonals)
+	UINT64 attacks(IVec2 start, const BoardState &board) override
+	{
+		Piece p = board.getPiece(start);
+		int dir = p.team ? -1 : 1;
+		UINT64 att = 0;
+		// Blocked at end of board (should promote before this happens)
+		if (start.y == (p.team ? 0 : 7)) return 0;
+		for (int i = -1; i <= 1; i += 2)
+		{
+			IVec2 end = start + IVec2(i, dir);
+			if (end.in88Square()) att |= SQUARE_BB(POS_TO_INDEX(end));
+		}
+		return att;
+	}
+
+	// Pawns attack their diagonals directly
+	bool attackPath(IVec2 start, IVec2 end, const BoardState &board, UINT64 &path) override
+	{
+		path = 0;
+		return (attacks(start, board) & SQUARE_BB(POS_TO_INDEX(end))) != 0;
+	}
+
+	// Pawn attacks have no path
+	bool hasAttackPaths() override
+	{
+		return true;
+	}
+
+	// Append the pseudolegal pawn moves to a move list, flagging special moves
+	void generateMoves(IVec2 start, const BoardState &board, MoveList &moves) override
+	{
+		Piece p = board.getPiece(start);
+		int dir = p.team ? -1 : 1;
+		int from = POS_TO_INDEX(start);
+		// Blocked at end of board (should promote before this happens)
+		if (start.y == (p.team ? 0 : 7)) return;
+		// Moves to the last squares of the board are promotions
+		IVec2 push = start + IVec2(0, dir);
+		byte promote = (push.y == 0 || push.y == 7) ? MovePromotion : MoveQuiet;
+		// Capture / en passant case
+		for (int i = -1; i <= 1; i += 2)
+		{
+			IVec2 end = start + IVec2(i, dir);
+			if (!end.in88Square()) continue;
+			// Normal capture
+			Piece cap = board.getPiece(end);
+			if (cap.team != p.team && cap.id != 0) moves.add(from, POS_TO_INDEX(end), MoveCapture | promote);
+			// En passant
+			Piece enp = board.getPiece(start + IVec2(i, 0));
+			if (cap.id == 0 && enp.team != p.team && enp.id == id && enp.spTemp == 1)
+			{
+				moves.add(from, POS_TO_INDEX(end), MoveCapture | MoveEnPassant | promote);
+			}
+		}
+		// Push moves
+		if (board[push] == 0)
+		{
+			moves.add(from, POS_TO_INDEX(push), promote);
+			IVec2 dbl = push + IVec2(0, dir);
+			if (!p.moved && dbl.in88Square() && board[dbl] == 0)
+			{
+				moves.add(from, POS_TO_INDEX(dbl), (dbl.y == 0 || dbl.y == 7) ? MovePromotion : MoveQuiet);
+			}
+		}
+	}
+
 	// Make move for simple pieces, overwrite if necessary (ex. en passant and castle)
 	// Return value decides if pawn is to be promoted or not
 	bool makeMove(IVec2 start, IVec2 end, BoardState& board) override
@@ -48,13 +159,13 @@ public:
 
 		if (delta.x != 0 && board[end] == 0) // En passant capture
 		{
-			board[start + IVec2(delta.x, 0)] = 0;
+			board.set(start + IVec2(delta.x, 0), 0);
 		}
 		// Set piece moved flag, and clear special bits
-		board[end] = board[start] | PIECE_MOVED;
-		board[start] = 0;
+		board.set(end, board[start] | PIECE_MOVED);
+		board.set(start, 0);
 		// Set special bits to 1 if pawn push
-		if (abs(delta.y) > 1) board[end] |= PIECE_SPTEMP;
+		if (abs(delta.y) > 1) board.set(end, board[end] | PIECE_SPTEMP);
 		// Return correct promote flag
 		return end.y == 0 || end.y == 7;
 	}
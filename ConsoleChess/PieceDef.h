@@ -1,10 +1,12 @@
 #pragma once
 
 #include <vector>
-#include <Windows.h>
+#include "Platform.h"
 #include "IVec2.h"
 #include "BoardState.h"
 #include "Byte88.h"
+#include "Bitboard.h"
+#include "MoveList.h"
 
 // Absract class for piece definitions. Should be inherited by the pieces to be added
 // in the game.
@@ -17,10 +19,46 @@ public:
 	bool critical;
 	// Byte88 struct containing icon for the piece (64 color bytes)
 	Byte88 sprite;
+	// Flag bits (PIECE_MOVED, PIECE_SPECIAL) which change the moves of the piece.
+	// Only these flags are part of the Zobrist hash (see ZobristKeys).
+	byte hashedFlags;
+	// Material value of the piece in centipawns (a pawn is 100), used by the AI
+	int value;
+	// True if the moves of the piece can never be taken back (pawns). Like captures, they
+	// reset the halfmove clock of the fifty-move rule (see Position::halfmoveClock).
+	bool irreversible;
+	// Bonus in centipawns of a white piece on each square, in the middle game and in the
+	// end game. Black pieces use the vertically mirrored squares.
+	short psqMg[64];
+	short psqEg[64];
 
 	// Constructor
-	PieceDef() : id(0), critical(0), sprite() {};
-	PieceDef(byte id, bool critical, Byte88 sprite) : id(id), critical(critical), sprite(sprite) {};
+	PieceDef() : id(0), critical(0), sprite(), hashedFlags(PIECE_MOVED | PIECE_SPECIAL), value(0),
+		irreversible(false), psqMg{ }, psqEg{ } {};
+	PieceDef(byte id, bool critical, const Byte88& sprite) : id(id), critical(critical), sprite(sprite),
+		hashedFlags(PIECE_MOVED | PIECE_SPECIAL), value(0), irreversible(false), psqMg{ }, psqEg{ } {};
+
+	// Weight of the piece in the game phase (see evaluate), one per 300 centipawns of value
+	// rounded. Pawns and critical pieces don't count.
+	int phaseWeight() const
+	{
+		return critical ? 0 : (value + 150) / 300;
+	}
+
+	// Derive a default evaluation from the amount of squares the piece attacks from each
+	// square of an empty board. The material value, if not set yet, grows with the average
+	// mobility (fitted on the standard pieces), and the squares with more mobility than the
+	// average get a bonus in the piece-square tables.
+	void deriveEvaluation(const int* mobility)
+	{
+		int total = 0;
+		for (int i = 0; i < 64; i++) { total += mobility[i]; }
+		if (value == 0 && !critical) { value = 70 + 35 * total / 64; }
+		for (int i = 0; i < 64; i++)
+		{
+			psqMg[i] = psqEg[i] = (short)(5 * (64 * mobility[i] - total) / 64);
+		}
+	}
 
 	// Check if potential move is pseudolegal, implemented by specific piece class.
 	// The return value is true if the move is valid and false otherwise.
@@ -29,14 +67,80 @@ public:
 		return false;
 	}
 
+	// Get the bitboard of the pseudolegal targets of the piece at start. This default
+	// implementation probes isValidMove on every square, pieces should override it
+	// with a faster generator returning the exact same set of moves.
+	virtual UINT64 targets(IVec2 start, const BoardState &board)
+	{
+		UINT64 tgts = 0;
+		for (int i = 0; i < 64; i++)
+		{
+			if (isValidMove(start, IVec2(i & 7, i >> 3), board)) { tgts |= SQUARE_BB(i); }
+		}
+		return tgts;
+	}
+
+	// Get the bitboard of the squares attacked by the piece at start, i.e. the squares
+	// it could capture on if an enemy piece stood there. The attack set must only depend
+	// on the occupancy of the squares inside it, which allows incremental attack maps.
+	// This default implementation probes isValidMove with an enemy piece on every square.
+	virtual UINT64 attacks(IVec2 start, const BoardState &board)
+	{
+		int from = POS_TO_INDEX(start);
+		byte enemy = ((board[from] & PIECE_TEAM) ^ PIECE_TEAM) | id;
+		BoardState probe = BoardState(board);
+		UINT64 att = 0;
+		for (int i = 0; i < 64; i++)
+		{
+			if (i == from) { continue; }
+			byte old = probe[i];
+			if (old == 0 || ((old ^ board[from]) & PIECE_TEAM) == 0) { probe.set(i, enemy); }
+			if (isValidMove(start, IVec2(i & 7, i >> 3), probe)) { att |= SQUARE_BB(i); }
+			probe.set(i, old);
+		}
+		return att;
+	}
+
+	// Get the squares which must be empty for the piece at start to attack end, on a board
+	// where only the piece at start matters. Returns false if the piece can never attack end
+	// from start. Used to find checks and pins without making moves, which is only done when
+	// every piece on the board has attack paths (see hasAttackPaths).
+	virtual bool attackPath(IVec2 start, IVec2 end, const BoardState &board, UINT64 &path)
+	{
+		return false;
+	}
+
+	// True if attackPath describes the attacks of this piece. Pieces returning true must
+	// only move themselves from start to end in makeMove, except for moves flagged as
+	// castle or en passant, which must follow the King and Pawn implementations.
+	virtual bool hasAttackPaths()
+	{
+		return false;
+	}
+
+	// Append the pseudolegal moves of the piece at start to a move list. This default
+	// implementation serializes targets(), pieces can override it to emit their moves
+	// directly and flag special moves (en passant, castle, promotion).
+	virtual void generateMoves(IVec2 start, const BoardState &board, MoveList &moves)
+	{
+		int from = POS_TO_INDEX(start);
+		UINT64 tgts = targets(start, board);
+		UINT64 enemies = board.teamBB[board.getPiece(from).team ^ 1];
+		while (tgts)
+		{
+			int to = popLsb(tgts);
+			moves.add(from, to, (enemies & SQUARE_BB(to)) ? MoveCapture : MoveQuiet);
+		}
+	}
+
 	// Make move for simple pieces, overwrite if necessary (ex. en passant and castle).
 	// The return value is a flag that if true tells the chess game to open a promotion
 	// dialog for this piece. In normal chess, only the pawns should return true after they
 	// have arrived to the last square.
 	virtual bool makeMove(IVec2 start, IVec2 end, BoardState& board)
 	{
-		board[end] = board[start] | PIECE_MOVED; // Set piece moved flag
-		board[start] = 0;
+		board.set(end, board[start] | PIECE_MOVED); // Set piece moved flag
+		board.set(start, 0);
 		// Return value controls piece promotion
 		return false;
 	}
@@ -0,0 +1,111 @@
+#pragma once
+#include <typeinfo>
+
+#include "Platform.h"
+#include "IVec2.h"
+#include "BoardState.h"
+#include "MoveList.h"
+#include "PieceDef.h"
+#include "UnitMovePiece.h"
+#include "Pawn.h"
+#include "King.h"
+
+// Kinds of piece sets a Position can dispatch its pieces with
+enum PieceSetKind
+{
+	PieceSetDynamic,	// Any pieces, through the PieceDef virtual functions
+	PieceSetStandard	// The pieces of StandardPieces, resolved at compile time
+};
+
+// Piece set policies give the move generation, attacks and moves of a board piece (its
+// byte, for the ID) from the piece definitions of a position. The move generation, the
+// legality filter and the attack map are templates on them, so the standard pieces don't
+// go through virtual calls in the hot loops.
+
+// Policy for any piece set, every call goes through the PieceDef of the piece.
+struct DynamicPieceSet
+{
+	static void generateMoves(PieceDef** defs, byte piece, IVec2 start, const BoardState& board, MoveList& moves)
+	{
+		defs[piece & PIECE_ID]->generateMoves(start, board, moves);
+	}
+
+	static UINT64 attacks(PieceDef** defs, byte piece, IVec2 start, const BoardState& board)
+	{
+		return defs[piece & PIECE_ID]->attacks(start, board);
+	}
+
+	static bool attackPath(PieceDef** defs, byte piece, IVec2 start, IVec2 end, const BoardState& board, UINT64& path)
+	{
+		return defs[piece & PIECE_ID]->attackPath(start, end, board, path);
+	}
+
+	static bool makeMove(PieceDef** defs, byte piece, IVec2 start, IVec2 end, BoardState& board)
+	{
+		return defs[piece & PIECE_ID]->makeMove(start, end, board);
+	}
+};
+
+// Policy for the pieces of StandardPieces: a Pawn with ID 1, UnitMovePieces with IDs 2 to 5
+// and a King with ID 6 (see matches). The ID selects the class at compile time, and its
+// functions are called without virtual dispatch so they can be inlined.
+struct StandardPieceSet
+{
+	// Check if the piece definitions of a position are laid out like StandardPieces. The
+	// pieces must be of these exact classes, subclasses may override their functions.
+	static bool matches(PieceDef* const* defs)
+	{
+		for (int id = 0; id < 16; id++)
+		{
+			if (id == 0 || id > 6)
+			{
+				if (defs[id] != NULL) { return false; }
+				continue;
+			}
+			if (defs[id] == NULL) { return false; }
+			const std::type_info& type = typeid(*defs[id]);
+			if (type != (id == 1 ? typeid(Pawn) : id == 6 ? typeid(King) : typeid(UnitMovePiece))) { return false; }
+		}
+		return true;
+	}
+
+	static void generateMoves(PieceDef** defs, byte piece, IVec2 start, const BoardState& board, MoveList& moves)
+	{
+		switch (piece & PIECE_ID)
+		{
+		case 1: static_cast<Pawn*>(defs[1])->Pawn::generateMoves(start, board, moves); break;
+		case 6: static_cast<King*>(defs[6])->King::generateMoves(start, board, moves); break;
+		default: static_cast<UnitMovePiece*>(defs[piece & PIECE_ID])->UnitMovePiece::generateMoves(start, board, moves); break;
+		}
+	}
+
+	static UINT64 attacks(PieceDef** defs, byte piece, IVec2 start, const BoardState& board)
+	{
+		switch (piece & PIECE_ID)
+		{
+		case 1: return static_cast<Pawn*>(defs[1])->Pawn::attacks(start, board);
+		case 6: return static_cast<King*>(defs[6])->King::attacks(start, board);
+		default: return static_cast<UnitMovePiece*>(defs[piece & PIECE_ID])->UnitMovePiece::attacks(start, board);
+		}
+	}
+
+	static bool attackPath(PieceDef** defs, byte piece, IVec2 start, IVec2 end, const BoardState& board, UINT64& path)
+	{
+		switch (piece & PIECE_ID)
+		{
+		case 1: return static_cast<Pawn*>(defs[1])->Pawn::attackPath(start, end, board, path);
+		case 6: return static_cast<King*>(defs[6])->King::attackPath(start, end, board, path);
+		default: return static_cast<UnitMovePiece*>(defs[piece & PIECE_ID])->UnitMovePiece::attackPath(start, end, board, path);
+		}
+	}
+
+	static bool makeMove(PieceDef** defs, byte piece, IVec2 start, IVec2 end, BoardState& board)
+	{
+		switch (piece & PIECE_ID)
+		{
+		case 1: return static_cast<Pawn*>(defs[1])->Pawn::makeMove(start, end, board);
+		case 6: return static_cast<King*>(defs[6])->King::makeMove(start, end, board);
+		default: return defs[piece & PIECE_ID]->PieceDef::makeMove(start, end, board);
+		}
+	}
+};
@@ -0,0 +1,36 @@
+#pragma once
+#include "Platform.h"
+
+// Define VERIFY_EVAL to check the incremental evaluation against a full recomputation
+// after every move. Enabled by default in debug builds.
+#if defined(_DEBUG) && !defined(VERIFY_EVAL)
+#define VERIFY_EVAL
+#endif
+
+// Material and piece-square scores of every piece on every square, summed by the board
+// as pieces are written (see BoardState::set), so the evaluation needs no work per node.
+// Scores are positive for white (team 1) and negative for black. Tables are indexed by
+// the team and ID bits of the board byte.
+struct PieceSquareTables
+{
+	int mg[32][64];	// Middle game score of each team and piece ID on each square
+	int eg[32][64];	// End game score of each team and piece ID on each square
+	int phase[32];	// Game phase weight of each team and piece ID
+
+	// Create empty tables, pieces are registered by the position owning them (see PieceTables)
+	PieceSquareTables() : mg{ }, eg{ }, phase{ } {};
+
+	// Register the evaluation of a piece ID: its material value, phase weight and its bonus
+	// tables for a white piece. Black pieces get the vertically mirrored squares.
+	void setPiece(int id, int value, int weight, const short* psqMg, const short* psqEg)
+	{
+		for (int sqr = 0; sqr < 64; sqr++)
+		{
+			mg[0x10 | id][sqr] = value + psqMg[sqr];
+			eg[0x10 | id][sqr] = value + psqEg[sqr];
+			mg[id][sqr ^ 56] = -(value + psqMg[sqr]);
+			eg[id][sqr ^ 56] = -(value + psqEg[sqr]);
+		}
+		phase[id] = phase[0x10 | id] = weight;
+	}
+};
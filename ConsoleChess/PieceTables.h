@@ -0,0 +1,29 @@
+#pragma once
+#include "Platform.h"
+#include "Zobrist.h"
+#include "PieceSquare.h"
+
+// Tables of a set of pieces the board keeps its hash and scores with: the flags hashed for
+// each piece ID (see PieceDef::hashedFlags) and the piece-square scores. Each position builds
+// the tables of its pieces, shared by its copies, so positions of different pieces never
+// share them. Boards made outside of a position use the default tables, which hash every
+// flag and score nothing.
+struct PieceTables
+{
+	byte hashedFlags[16];	// Flags hashed for each piece ID
+	PieceSquareTables psq;	// Scores of each piece on each square
+
+	// Create the default tables
+	PieceTables()
+	{
+		for (int i = 0; i < 16; i++) { hashedFlags[i] = 0xE0; }
+		hashedFlags[0] = 0; // Empty squares
+	}
+};
+
+// Get the default tables, of boards made outside of a position
+inline const PieceTables& defaultPieceTables()
+{
+	static const PieceTables tables;
+	return tables;
+}
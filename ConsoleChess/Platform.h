@@ -0,0 +1,25 @@
+#pragma once
+
+// Types and functions the engine headers take from <Windows.h>. The game window
+// needs Windows, but the board, pieces and move generation also build on other
+// platforms so the command line tools (see Perft) can run anywhere.
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+
+typedef unsigned char byte;
+typedef unsigned short UINT16;
+typedef unsigned int UINT32;
+typedef unsigned long long UINT64;
+
+// Bounds checked memcpy from the MSVC runtime
+inline int memcpy_s(void* dest, size_t destSize, const void* src, size_t count)
+{
+	if (count > destSize) { return 34; } // ERANGE
+	memcpy(dest, src, count);
+	return 0;
+}
+#endif
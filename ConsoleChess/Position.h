@@ -0,0 +1,407 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <cassert>
+
+#include "Platform.h"
+#include "PieceDef.h"
+#include "BoardState.h"
+#include "MoveList.h"
+#include "AttackMap.h"
+#include "Legality.h"
+#include "PieceSet.h"
+#include "Zobrist.h"
+
+// Rules of the game without any user interface: the piece definitions, the
+// board and the team to move. ChessGame adds the window on top of it, and the
+// command line tools (see Perft) use it directly.
+class Position
+{
+protected:
+	UndoStack undoStack; // Undo record of the last moves made, the last move on top
+	int reversiblePlies; // Plies since the last irreversible move, the positions a repetition can be found in
+	int pieceSet; // PieceSetKind the pieces are dispatched with
+	std::shared_ptr<PieceTables> tables; // Tables of the pieces the board is hashed and scored with, shared by the copies
+
+	// Update the attack map after the pieces on the changed squares were modified
+	void updateAttacks(UINT64 changed)
+	{
+		if (pieceSet == PieceSetStandard) { attackMap.update<StandardPieceSet>(board, pieceDefs, changed); }
+		else { attackMap.update(board, pieceDefs, changed); }
+	}
+
+	// Append the pseudolegal moves of every piece of a team to a move list
+	template<typename Set>
+	void generatePseudoMoves(bool team, MoveList& moves)
+	{
+		UINT64 pieces = board.teamBB[team];
+		while (pieces)
+		{
+			int k = popLsb(pieces);
+			Set::generateMoves(pieceDefs, board[k], IVec2(k & 7, k >> 3), board, moves);
+		}
+	}
+
+public:
+	PieceDef* pieceDefs[16];	// Array of pointers to PieceDef
+	BoardState board;			// Current board state
+	AttackMap attackMap;		// Attack counts of the current board state
+
+	byte currTeam; // Current team/color
+	int halfmoveClock; // Plies since the last capture or irreversible piece move, for the fifty-move rule
+
+	// Create position with the given pieces and an empty board
+	Position(std::vector<PieceDef*> pieces) : reversiblePlies(0), pieceSet(PieceSetDynamic), tables(new PieceTables()),
+		pieceDefs{ }, currTeam(1), halfmoveClock(0)
+	{
+		// Assign the pieces in PieceDefs at their ID, and register their hashed flags and scores
+		for (int i = 0; i < pieces.size(); i++)
+		{
+			PieceDef* def = pieces[i];
+			pieceDefs[def->id] = def;
+			tables->hashedFlags[def->id] = def->hashedFlags;
+			tables->psq.setPiece(def->id, def->value, def->phaseWeight(), def->psqMg, def->psqEg);
+		}
+		board.tables = tables.get();
+	}
+
+	// Create position with the given pieces and board
+	Position(std::vector<PieceDef*> pieces, const BoardState& bstate, byte team) : Position(pieces)
+	{
+		setBoard(bstate, team);
+	}
+
+	// Dispatch the pieces with a PieceSetKind. Returns false and keeps dispatching them
+	// dynamically if the pieces don't match the kind (see StandardPieceSet::matches).
+	bool usePieceSet(int kind)
+	{
+		pieceSet = (kind == PieceSetStandard && StandardPieceSet::matches(pieceDefs)) ? PieceSetStandard : PieceSetDynamic;
+		return pieceSet == kind;
+	}
+
+	// Get the PieceSetKind the pieces are dispatched with
+	int getPieceSet() const
+	{
+		return pieceSet;
+	}
+
+	// Replace the board and the team to move. Clears the moves to undo and the position history.
+	void setBoard(const BoardState& bstate, byte team)
+	{
+		board = BoardState(bstate);
+		board.tables = tables.get();
+		board.syncBitboards(); // Rehash in case the board was hashed with other pieces
+		currTeam = team;
+		undoStack.clear();
+		halfmoveClock = reversiblePlies = 0;
+		if (pieceSet == PieceSetStandard) { attackMap.compute<StandardPieceSet>(board, pieceDefs); }
+		else { attackMap.compute(board, pieceDefs); }
+	}
+
+	// Get the Zobrist key of the position: the board hash and the team to move
+	UINT64 hashKey() const
+	{
+		return board.hash ^ (currTeam ? zobrist().side : 0);
+	}
+
+	// Get the Zobrist key after a move without making it, to prefetch hash table entries.
+	// Exact for moves which only move the piece and set its moved flag, when no piece
+	// has the temporary special flag. Other moves give an unrelated key.
+	UINT64 keyAfter(const Move& move) const
+	{
+		const ZobristKeys& keys = zobrist();
+		byte piece = board[move.from()];
+		UINT64 key = hashKey() ^ keys.side;
+		const byte* hashed = tables->hashedFlags;
+		key ^= keys.key(move.from(), piece, hashed) ^ keys.key(move.to(), board[move.to()], hashed);
+		return key ^ keys.key(move.to(), piece | PIECE_MOVED, hashed);
+	}
+
+	// Compare the board hash with a full recomputation. Returns true if they match.
+	bool verifyHash() const
+	{
+		return board.hash == board.computeHash();
+	}
+
+	// Compare the board scores with a full recomputation. Returns true if they match.
+	bool verifyEval() const
+	{
+		int mg, eg, ph;
+		board.computeScores(mg, eg, ph);
+		return mg == board.psqMg && eg == board.psqEg && ph == board.phase;
+	}
+
+	// Check if piece is attacked using the attack map
+	bool isAttacked(IVec2 pos)
+	{
+		// Get target piece
+		Piece tgt = board.getPiece(pos);
+		if (tgt.id == 0) { return false; } // Can't attack a nonexistent piece
+		return attackMap.isAttacked(POS_TO_INDEX(pos), tgt.team ^ 1);
+	}
+
+	// Make a move (without updating the rendered chess board).
+	bool makeMove(IVec2 start, IVec2 end)
+	{
+		// Push an undo record, the board records its writes in it
+		UndoRecord& undo = undoStack.push();
+		undo.count = 0;
+		undo.key = hashKey();
+		undo.halfmoveClock = halfmoveClock;
+		undo.reversiblePlies = reversiblePlies;
+		board.journal = &undo;
+		// Clear temp special bit
+		board.clearSpTemp();
+		// Let piece perform the move
+		byte p = board[start];
+		int pieces = popCount(board.occupied);
+		board.dirty = 0;
+		bool promote = (pieceSet == PieceSetStandard) ? StandardPieceSet::makeMove(pieceDefs, p, start, end, board) :
+			DynamicPieceSet::makeMove(pieceDefs, p, start, end, board);
+		board.journal = NULL;
+		// Captures and irreversible pieces reset the halfmove clock. The first move of a piece
+		// which hashes its moved flag (ex. a king losing the castling rights) changes the key
+		// for good, so no earlier position can repeat after it either.
+		if (popCount(board.occupied) < pieces || pieceDefs[p & PIECE_ID]->irreversible) { halfmoveClock = 0; }
+		else { halfmoveClock++; }
+		bool firstMove = !(p & PIECE_MOVED) && (tables->hashedFlags[p & PIECE_ID] & PIECE_MOVED);
+		reversiblePlies = (halfmoveClock == 0 || firstMove) ? 0 : reversiblePlies + 1;
+		// Update the attack map on the squares the move changed
+		undo.changed = board.dirty;
+		updateAttacks(undo.changed);
+#ifdef VERIFY_HASH
+		assert(verifyHash());
+#endif
+#ifdef VERIFY_EVAL
+		assert(verifyEval());
+#endif
+		// Change current playing team
+		currTeam ^= 1;
+		// Return promotion flag
+		return promote;
+	}
+
+	// Undo the last move made (without updating the rendered chess board). Moves can be
+	// undone back to the last setBoard, up to the last UNDO_STACK_SIZE moves.
+	void undoMove()
+	{
+		// Write back the old bytes, last write first
+		const UndoRecord& undo = undoStack.back();
+		for (int i = undo.count - 1; i >= 0; i--) { board.set(undo.squares[i], undo.old[i]); }
+		// Revert the attack map on the squares the move changed
+		updateAttacks(undo.changed);
+		board.dirty = undo.changed;
+		halfmoveClock = undo.halfmoveClock;
+		reversiblePlies = undo.reversiblePlies;
+		undoStack.pop();
+		// Change current playing team
+		currTeam ^= 1;
+	}
+
+	// Amount of moves which can be undone
+	int undoDepth() const
+	{
+		return undoStack.size();
+	}
+
+	// Get the undo record of the last move made. There must be one.
+	const UndoRecord& lastMove() const
+	{
+		return undoStack.back();
+	}
+
+	// Count the earlier occurrences of the current position with the same team to move,
+	// among the positions since the last irreversible move
+	int repetitions() const
+	{
+		UINT64 key = hashKey();
+		int last = undoStack.size(), count = 0;
+		for (int i = 2; i <= reversiblePlies && i <= last; i += 2)
+		{
+			if (undoStack[last - i].key == key) { count++; }
+		}
+		return count;
+	}
+
+	// Check if the position is a draw by the fifty-move rule: fifty moves of each team
+	// without a capture or an irreversible piece move
+	bool fiftyMoveDraw() const
+	{
+		return halfmoveClock >= 100;
+	}
+
+	// Check if the piece at a position can be promoted to a piece ID.
+	// Any defined piece which is not critical and not the piece itself is allowed.
+	bool canPromote(IVec2 pos, int id)
+	{
+		return pieceDefs[id] != NULL && !pieceDefs[id]->critical && board.getPiece(pos).id != id;
+	}
+
+	// Replace the piece at a position by another piece of the same team. Part of the last
+	// move made, undoing it also undoes the promotion.
+	void promote(IVec2 pos, byte id)
+	{
+		UndoRecord* undo = undoStack.empty() ? NULL : &undoStack.back();
+		board.journal = undo;
+		board.set(pos, (board[pos] & PIECE_TEAM) | id);
+		board.journal = NULL;
+		if (undo != NULL) { undo->changed |= SQUARE_BB(POS_TO_INDEX(pos)); }
+		updateAttacks(SQUARE_BB(POS_TO_INDEX(pos)));
+#ifdef VERIFY_HASH
+		assert(verifyHash());
+#endif
+#ifdef VERIFY_EVAL
+		assert(verifyEval());
+#endif
+	}
+
+	// Return true if any critical pieces are under attack
+	bool inCheck(bool team)
+	{	// Go through every piece of the team
+		UINT64 pieces = board.teamBB[team];
+		while (pieces)
+		{
+			// Check if the piece is a crit, and if yes check if it's attacked
+			int i = popLsb(pieces);
+			IVec2 v = IVec2(i & 7, i >> 3);
+			if (pieceDefs[board[i] & PIECE_ID]->critical && isAttacked(v)) { return true; }
+		}
+		return false;
+	}
+
+	// Append the legal moves of a team to a move list, and return the amount.
+	// kinds selects the noisy moves (captures and promotions), the quiet moves or both.
+	int generateLegalMoves(bool team, MoveList& legal, int kinds = MovesAll)
+	{
+		// Compute checks and pins once for the whole position
+		Legality legality = Legality();
+		computeLegality(legality, team);
+		return generateLegalMoves(team, legal, kinds, legality);
+	}
+
+	// Compute the legality filter of a team for the current board
+	void computeLegality(Legality& legality, bool team)
+	{
+		if (pieceSet == PieceSetStandard) { legality.compute<StandardPieceSet>(board, pieceDefs, attackMap, team); }
+		else { legality.compute(board, pieceDefs, attackMap, team); }
+	}
+
+	// Append the legal moves of a team to a move list using a legality filter computed
+	// for the current board, and return the amount. The list must be the last one created.
+	int generateLegalMoves(bool team, MoveList& legal, int kinds, const Legality& legality)
+	{
+		// Generate the pseudolegal moves of all pieces of the team at the end of the list
+		int first = legal.size;
+		if (pieceSet == PieceSetStandard) { generatePseudoMoves<StandardPieceSet>(team, legal); }
+		else { generatePseudoMoves<DynamicPieceSet>(team, legal); }
+		// Keep the legal moves of the wanted kinds, in place
+		int cnt = first;
+		for (int i = first; i < legal.size; i++)
+		{
+			Move m = legal[i];
+			if ((kinds & (isNoisy(m.flags()) ? MovesNoisy : MovesQuiet)) == 0) { continue; }
+			if (isLegal(team, m, legality)) { legal[cnt++] = m; }
+		}
+		legal.truncate(cnt);
+		return cnt - first;
+	}
+
+	// Check if a pseudolegal move of a team is legal, using a legality filter computed
+	// for the current board
+	bool isLegal(bool team, const Move& move, const Legality& legality)
+	{
+		if (legality.usable) { return legality.isLegal(move); }
+		// Perform the move and see if it leads to check
+		makeMove(move.start(), move.end());
+		bool ok = !inCheck(team);
+		undoMove();
+		return ok;
+	}
+
+	// Append the pseudolegal moves of the piece on a square to a move list
+	void generatePieceMoves(int sqr, MoveList& moves)
+	{
+		IVec2 start = IVec2(sqr & 7, sqr >> 3);
+		if (pieceSet == PieceSetStandard) { StandardPieceSet::generateMoves(pieceDefs, board[sqr], start, board, moves); }
+		else { DynamicPieceSet::generateMoves(pieceDefs, board[sqr], start, board, moves); }
+	}
+
+	// Append the legal moves of the piece on a square to a move list using a legality filter
+	// computed for its team, and return the amount. The list must be the last one created.
+	int generatePieceLegalMoves(int sqr, MoveList& legal, const Legality& legality)
+	{
+		byte p = board[sqr];
+		if (p == 0) { return 0; }
+		bool team = (p & PIECE_TEAM) != 0;
+		int first = legal.size;
+		generatePieceMoves(sqr, legal);
+		int cnt = first;
+		for (int i = first; i < legal.size; i++)
+		{
+			Move m = legal[i];
+			if (isLegal(team, m, legality)) { legal[cnt++] = m; }
+		}
+		legal.truncate(cnt);
+		return cnt - first;
+	}
+
+	// Check if a team has any legal move, using a legality filter computed for the current
+	// board. Stops at the first legal move found, without generating the moves of the other
+	// pieces. In check the critical pieces are tried first, since moving them is the most
+	// likely escape, otherwise they are tried last.
+	bool hasAnyLegalMove(bool team, const Legality& legality)
+	{
+		UINT64 crits = 0;
+		for (int id = 1; id < 16; id++)
+		{
+			if (pieceDefs[id] != NULL && pieceDefs[id]->critical) { crits |= board.pieceBB[team][id]; }
+		}
+		UINT64 others = board.teamBB[team] & ~crits;
+		bool critsFirst = !legality.usable || legality.checkers != 0;
+		return hasLegalMoveIn(critsFirst ? crits : others, legality) || hasLegalMoveIn(critsFirst ? others : crits, legality);
+	}
+
+	// Check if a team has any legal move
+	bool hasAnyLegalMove(bool team)
+	{
+		Legality legality = Legality();
+		computeLegality(legality, team);
+		return hasAnyLegalMove(team, legality);
+	}
+
+	// Check if any of the pieces on a bitboard has a legal move, using a legality filter
+	// computed for their team
+	bool hasLegalMoveIn(UINT64 pieces, const Legality& legality)
+	{
+		while (pieces)
+		{
+			int k = popLsb(pieces);
+			bool team = (board[k] & PIECE_TEAM) != 0;
+			MoveList moves;
+			generatePieceMoves(k, moves);
+			for (int i = 0; i < moves.size; i++)
+			{
+				if (isLegal(team, moves[i], legality)) { return true; }
+			}
+		}
+		return false;
+	}
+
+	// Find the legal move of a team between two squares, and fill in its flags. Used for
+	// moves remembered from other positions (ex. by the AI), which may not be possible here.
+	bool findLegalMove(bool team, int from, int to, Move& move, const Legality& legality)
+	{
+		byte p = board[from];
+		if (p == 0 || ((p & PIECE_TEAM) != 0) != team) { return false; }
+		MoveList moves;
+		generatePieceMoves(from, moves);
+		for (int i = 0; i < moves.size; i++)
+		{
+			if (moves[i].to() != to) { continue; }
+			move = moves[i];
+			return isLegal(team, move, legality);
+		}
+		return false;
+	}
+};
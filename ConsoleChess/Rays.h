@@ -0,0 +1,37 @@
+#pragma once
+#include "Platform.h"
+#include "Bitboard.h"
+
+// Squares between two squares on the same rank, file or diagonal of the board. Pieces
+// with other paths describe them in their own tables (see UnitMoveset::between).
+struct RayTables
+{
+	UINT64 between[64][64];	// Squares strictly between two squares, empty if they aren't on a line
+};
+
+// Build the ray tables from the board geometry
+constexpr RayTables makeRayTables()
+{
+	RayTables t = { };
+	const int dirs[8][2] = { { 1, 0 }, { -1, 0 }, { 0, 1 }, { 0, -1 }, { 1, 1 }, { -1, -1 }, { 1, -1 }, { -1, 1 } };
+	for (int a = 0; a < 64; a++)
+	{
+		int ax = a & 7, ay = a >> 3;
+		for (int d = 0; d < 8; d++)
+		{
+			int dx = dirs[d][0], dy = dirs[d][1];
+			// Walk away from a, the squares passed are between a and the next one
+			UINT64 passed = 0;
+			for (int x = ax + dx, y = ay + dy; x >= 0 && x < 8 && y >= 0 && y < 8; x += dx, y += dy)
+			{
+				int b = y << 3 | x;
+				t.between[a][b] = passed;
+				passed |= SQUARE_BB(b);
+			}
+		}
+	}
+	return t;
+}
+
+// Ray tables of the board, built when compiling
+constexpr RayTables BoardRays = makeRayTables();
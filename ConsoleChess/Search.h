@@ -0,0 +1,353 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "Platform.h"
+#include "Position.h"
+#include "Evaluation.h"
+#include "MovePicker.h"
+#include "Nnue.h"
+#include "See.h"
+#include "TranspositionTable.h"
+
+#define SCORE_INFINITE 32000	// Bound of all scores
+#define SCORE_MATE 31000		// Score of being mated at the root, mates further away score less
+#define SCORE_MATE_BOUND (SCORE_MATE - MAX_PLY) // Scores past this are mates
+
+// Kinds of scores stored in the transposition table
+enum SearchBound
+{
+	BoundUpper = 1,	// Score is at most the stored one (no move raised alpha)
+	BoundLower = 2,	// Score is at least the stored one (beta cutoff)
+	BoundExact = 3	// Exact score
+};
+
+// Result of a search iteration
+struct SearchInfo
+{
+	int depth;					// Depth of the last completed iteration
+	int score;					// Score of the best move for the team to move, in centipawns
+	UINT64 nodes;				// Positions visited, quiescence included
+	double seconds;				// Time since the start of the search
+	SearchMove pv[MAX_PLY];		// Principal variation, the expected line of play
+	int pvLength;				// Amount of moves in pv
+
+	// Nodes searched per second
+	UINT64 nps() const
+	{
+		return seconds > 0 ? (UINT64)(nodes / seconds) : 0;
+	}
+
+	// Amount of moves to a forced mate (negative if the team to move gets mated), 0 if none
+	int mateIn() const
+	{
+		if (score >= SCORE_MATE_BOUND) { return (SCORE_MATE - score + 1) / 2; }
+		if (score <= -SCORE_MATE_BOUND) { return -(SCORE_MATE + score) / 2; }
+		return 0;
+	}
+};
+
+// Negamax alpha-beta search with iterative deepening, for the AI player.
+// Moves are generated through the PieceDefs of the position, so custom pieces need
+// nothing more than a value. The search copies the position it is given and makes and
+// undoes its moves on the copy, so the game's board is never touched while it runs.
+class Search
+{
+private:
+	std::unique_ptr<Position> position;		// Copy of the root, where the moves of the current line are made
+	SearchMove pvTable[MAX_PLY + 1][MAX_PLY];	// Principal variation found from each ply
+	int pvLength[MAX_PLY + 1];				// Length of each principal variation
+	UINT64 nodes;							// Positions visited by the current search
+	std::chrono::steady_clock::time_point startTime; // Start of the current search
+	long long timeLimit;					// Time budget in ms
+	std::atomic<bool> stopped;				// Set to abort the current search
+	SearchMove line[MAX_PLY + 1];			// Move made at each ply of the current line
+	MoveHistory history;					// Killer, history and countermove tables
+	const Nnue* network;					// Network evaluating the search, NULL for the classical evaluation
+	std::vector<NnueAccumulator> accumulators; // Network accumulator of each ply
+
+	// Milliseconds since the start of the search
+	long long elapsed() const
+	{
+		return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count();
+	}
+
+	// Check the clock every few nodes, and return true if the search must stop
+	bool checkStop()
+	{
+		if ((nodes & 1023) == 0 && elapsed() >= timeLimit) { stopped = true; }
+		return stopped;
+	}
+
+	// Mate scores are stored relative to the node in the transposition table
+	static int scoreToTT(int score, int ply)
+	{
+		return score >= SCORE_MATE_BOUND ? score + ply : score <= -SCORE_MATE_BOUND ? score - ply : score;
+	}
+
+	static int scoreFromTT(int score, int ply)
+	{
+		return score >= SCORE_MATE_BOUND ? score - ply : score <= -SCORE_MATE_BOUND ? score + ply : score;
+	}
+
+	// Make the move of a ply, leading to the position of the next ply
+	void makeMove(int ply, const SearchMove& m)
+	{
+		Position& pos = *position;
+		line[ply] = m;
+		if (pos.makeMove(m.start(), m.end()) && m.promotion != 0) { pos.promote(m.end(), m.promotion); }
+		if (network != NULL) { network->update(accumulators[ply], accumulators[ply + 1], pos.board, pos.lastMove()); }
+	}
+
+	// Static evaluation of the position of a ply for the team to move, by the network if
+	// one is loaded. Network scores are kept out of the mate range.
+	int staticEval(int ply)
+	{
+		if (network == NULL) { return evaluate(*position); }
+		int score = network->evaluate(accumulators[ply], position->currTeam);
+		return score >= SCORE_MATE_BOUND ? SCORE_MATE_BOUND - 1 : score <= -SCORE_MATE_BOUND ? -SCORE_MATE_BOUND + 1 : score;
+	}
+
+	// Put a move in front of the principal variation of the next ply
+	void updatePv(int ply, const SearchMove& m)
+	{
+		int n = (pvLength[ply + 1] < MAX_PLY - 1) ? pvLength[ply + 1] : MAX_PLY - 1;
+		pvTable[ply][0] = m;
+		for (int i = 0; i < n; i++) { pvTable[ply][i + 1] = pvTable[ply + 1][i]; }
+		pvLength[ply] = n + 1;
+	}
+
+	// Search captures and promotions until the position is quiet, so that the static
+	// evaluation is never taken in the middle of an exchange. Captures losing material by
+	// static exchange evaluation are skipped. Checks are searched fully.
+	int quiesce(int ply, int alpha, int beta)
+	{
+		Position& pos = *position;
+		pvLength[ply] = 0;
+		nodes++;
+		if (checkStop()) { return 0; }
+		bool check = pos.inCheck(pos.currTeam);
+		if (ply >= MAX_PLY) { return staticEval(ply); }
+
+		int best = -SCORE_INFINITE;
+		if (!check)
+		{	// Standing pat, the team to move can always decline the captures
+			best = staticEval(ply);
+			if (best >= beta) { return best; }
+			if (best > alpha) { alpha = best; }
+		}
+		MovePicker picker(pos, SearchMove{ }, NULL, ply, SearchMove{ }, !check);
+		SearchMove move;
+		int count = 0;
+		while (picker.next(move))
+		{
+			count++;
+			if (!check && see(pos, Move(move.from, move.to, move.flags), move.promotion) < 0) { continue; }
+			makeMove(ply, move);
+			int score = -quiesce(ply + 1, -beta, -alpha);
+			pos.undoMove();
+			if (stopped) { return 0; }
+			if (score > best)
+			{
+				best = score;
+				if (score > alpha)
+				{
+					alpha = score;
+					updatePv(ply, move);
+					if (alpha >= beta) { break; }
+				}
+			}
+		}
+		if (check && count == 0) { return -SCORE_MATE + ply; }
+		return best;
+	}
+
+	// Negamax alpha-beta search of a ply to a depth. Returns the score of the position for
+	// the team to move, exact if it is between alpha and beta and a bound otherwise.
+	int negamax(int ply, int depth, int alpha, int beta)
+	{
+		Position& pos = *position;
+		bool check = pos.inCheck(pos.currTeam);
+		if (check) { depth++; } // Search checks one ply deeper
+		if (depth <= 0) { return quiesce(ply, alpha, beta); }
+		pvLength[ply] = 0;
+		nodes++;
+		if (checkStop()) { return 0; }
+		if (ply >= MAX_PLY) { return staticEval(ply); }
+		// Draw by the fifty-move rule, or by repetition: repeating once is enough, since the
+		// team which could avoid it would have done so the first time
+		if (ply > 0 && (pos.fiftyMoveDraw() || pos.repetitions() > 0)) { return 0; }
+
+		// Use the transposition table to cut the node or to find the move to try first
+		UINT64 key = pos.hashKey();
+		SearchMove hashMove = SearchMove{ };
+		TTData entry;
+		if (tt != NULL && tt->probe(key, entry))
+		{
+			hashMove = SearchMove::unpack(entry.value);
+			int score = scoreFromTT((short)(entry.value >> 16), ply);
+			if (ply > 0 && entry.depth >= depth && (entry.bound == BoundExact ||
+				(entry.bound == BoundLower && score >= beta) || (entry.bound == BoundUpper && score <= alpha)))
+			{
+				return score;
+			}
+		}
+
+		// The countermove is the reply which refuted the previous move elsewhere
+		int prevPiece = 0, prevTo = 0;
+		SearchMove counter = SearchMove{ };
+		if (ply > 0)
+		{
+			prevTo = line[ply - 1].to;
+			prevPiece = pos.board[prevTo] & 0x1F;
+			counter = history.counters[prevPiece][prevTo];
+		}
+
+		MovePicker picker(pos, hashMove, &history, ply, counter);
+		SearchMove move;
+		SearchMove quiets[64];	// Quiet moves tried, which lose history score on a cutoff
+		int count = 0, nQuiets = 0;
+		int oldAlpha = alpha;
+		int best = -SCORE_INFINITE;
+		SearchMove bestMove = SearchMove{ };
+		while (picker.next(move))
+		{
+			count++;
+			makeMove(ply, move);
+			int score = -negamax(ply + 1, depth - 1, -beta, -alpha);
+			pos.undoMove();
+			if (stopped) { return 0; }
+			if (score > best)
+			{
+				best = score;
+				bestMove = move;
+				if (score > alpha)
+				{
+					alpha = score;
+					updatePv(ply, move);
+					if (alpha >= beta)
+					{	// Quiet moves causing a cutoff are tried early in other nodes
+						if (!isNoisy(move.flags)) { history.update(pos.currTeam, ply, move, prevPiece, prevTo, quiets, nQuiets, depth); }
+						break;
+					}
+				}
+			}
+			if (!isNoisy(move.flags) && nQuiets < 64) { quiets[nQuiets++] = move; }
+		}
+		if (count == 0) { return check ? -SCORE_MATE + ply : 0; } // Checkmate or stalemate
+
+		if (tt != NULL)
+		{
+			int bound = best >= beta ? BoundLower : best > oldAlpha ? BoundExact : BoundUpper;
+			UINT64 value = bestMove.pack() | (UINT64)(unsigned short)scoreToTT(best, ply) << 16;
+			tt->store(key, TTData{ value, depth, bound });
+		}
+		return best;
+	}
+
+	// True if a helper thread of a parallel search skips an iteration depth. Helpers are
+	// split into groups which search every other depth, every 2nd, 3rd or 4th pair of depths
+	// with different phases, so that at any time the threads search different depths.
+	static bool skipDepth(int thread, int depth)
+	{
+		static const int skipSize[20] = { 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 4, 4, 4, 4, 4, 4, 4, 4 };
+		static const int skipPhase[20] = { 0, 1, 0, 1, 2, 3, 0, 1, 2, 3, 4, 5, 0, 1, 2, 3, 4, 5, 6, 7 };
+		if (thread == 0) { return false; }
+		int i = (thread - 1) % 20;
+		return ((depth + skipPhase[i]) / skipSize[i]) % 2 != 0;
+	}
+
+public:
+	TranspositionTable* tt;	// Table shared with other searches, or NULL to search without one
+	SearchInfo info;		// Result of the last completed iteration
+	SearchMove bestMove;	// Best move found, can come from an aborted iteration
+	int thread;				// Index of the search in a parallel search (see SmpSearch), 0 for the main one
+	std::function<void(const SearchInfo&)> onIteration; // Called after each completed iteration
+
+	// Create search using a transposition table (can be NULL)
+	Search(TranspositionTable* tt = NULL) : nodes(0), timeLimit(0), stopped(false), network(NULL), tt(tt), info(), bestMove(), thread(0) {};
+
+	// Find the best move of a position within a time budget in ms, searching at most
+	// maxDepth plies. Returns the null move if the team to move has no legal moves.
+	SearchMove think(const Position& root, long long timeMs, int maxDepth = MAX_PLY - 1)
+	{
+		if (tt != NULL) { tt->newSearch(); }
+		start(root, timeMs);
+		iterate(maxDepth);
+		return bestMove;
+	}
+
+	// Set up a search of a position within a time budget in ms, without running it.
+	// Unlike think, this doesn't age the transposition table entries.
+	void start(const Position& root, long long timeMs)
+	{
+		startTime = std::chrono::steady_clock::now();
+		timeLimit = timeMs;
+		stopped = false;
+		nodes = 0;
+		info = SearchInfo();
+		bestMove = SearchMove{ };
+		if (position == NULL) { position.reset(new Position(root)); }
+		else { *position = root; } // Reuses the memory of the undo stack
+		network = nnue().loaded ? &nnue() : NULL;
+		if (network != NULL)
+		{
+			if (accumulators.size() != MAX_PLY + 1) { accumulators.resize(MAX_PLY + 1); }
+			network->refresh(position->board, accumulators[0]);
+		}
+		history.age();
+	}
+
+	// Run the iterative deepening of a started search, to at most maxDepth plies
+	void iterate(int maxDepth)
+	{
+		for (int depth = 1; depth <= maxDepth && depth < MAX_PLY; depth++)
+		{
+			if (skipDepth(thread, depth)) { continue; }
+			int score = negamax(0, depth, -SCORE_INFINITE, SCORE_INFINITE);
+			// Moves of an aborted iteration are only kept if they beat the previous best
+			if (pvLength[0] > 0) { bestMove = pvTable[0][0]; }
+			if (stopped) { break; }
+
+			info.depth = depth;
+			info.score = score;
+			info.nodes = nodes;
+			info.seconds = elapsed() / 1000.0;
+			info.pvLength = pvLength[0];
+			std::copy(pvTable[0], pvTable[0] + pvLength[0], info.pv);
+			if (onIteration) { onIteration(info); }
+
+			// Stop on forced mates, and when the next iteration would likely run out of time.
+			// Helper threads run until the main thread stops them.
+			if (info.mateIn() != 0 || (thread == 0 && elapsed() * 2 >= timeLimit)) { break; }
+		}
+		info.nodes = nodes;
+		info.seconds = elapsed() / 1000.0;
+
+		if (bestMove.isNull())
+		{	// Out of time before a move was searched, play the first one
+			MovePicker picker(*position, SearchMove{ });
+			picker.next(bestMove);
+		}
+	}
+
+	// Score a position for the team to move with the quiescence search alone: only the
+	// captures and promotions are searched, until the position is quiet. Meant for bulk
+	// analysis, to settle the exchanges of many positions without a full search.
+	int resolve(const Position& root)
+	{
+		start(root, LLONG_MAX);
+		return quiesce(0, -SCORE_INFINITE, SCORE_INFINITE);
+	}
+
+	// Abort the current search from another thread. think() returns the best move so far.
+	void stop()
+	{
+		stopped = true;
+	}
+};
@@ -0,0 +1,96 @@
+#pragma once
+#include "Platform.h"
+#include "Position.h"
+#include "MoveList.h"
+#include "Bitboard.h"
+
+#define SEE_CRITICAL_VALUE 20000	// Value of critical pieces in exchanges, so they capture last
+
+// Value of a board piece in exchanges
+inline int seeValue(const Position& pos, byte piece)
+{
+	PieceDef* def = pos.pieceDefs[piece & PIECE_ID];
+	if (def == NULL) { return 0; }
+	return def->critical ? SEE_CRITICAL_VALUE : def->value;
+}
+
+// Static exchange evaluation of a capture: the material won by the team making it, in
+// centipawns, once both teams have recaptured on the end square with their least valuable
+// pieces for as long as it pays off. promotion is the ID of the piece a promoting move
+// promotes to. Pins are ignored.
+// The attackers of the square are found by asking each PieceDef for its attack path to it
+// (see PieceDef::attackPath), so pieces behind a slider join the exchange once the path is
+// cleared. Pieces without attack paths only attack through the attack map, with no x-rays.
+inline int see(const Position& pos, const Move& move, int promotion = 0)
+{
+	const BoardState& board = pos.board;
+	IVec2 target = move.end();
+	UINT64 occ = board.occupied & ~SQUARE_BB(move.from());
+	int captured = board[move.to()] ? seeValue(pos, board[move.to()]) : 0;
+	if (move.flags() & MoveEnPassant)
+	{	// The captured pawn is beside the start square, on the end column
+		int sqr = (move.from() & ~7) | (move.to() & 7);
+		captured = seeValue(pos, board[sqr]);
+		occ &= ~SQUARE_BB(sqr);
+	}
+	int attacker = seeValue(pos, board[move.from()]);
+	if (promotion != 0)
+	{
+		captured += pos.pieceDefs[promotion]->value - attacker;
+		attacker = pos.pieceDefs[promotion]->value;
+	}
+
+	// Find the pieces which can attack the target, and the squares which must be empty for them
+	UINT64 paths[64];
+	UINT64 candidates = 0;
+	UINT64 pieces = occ & ~SQUARE_BB(move.to());
+	while (pieces)
+	{
+		int i = popLsb(pieces);
+		PieceDef* def = pos.pieceDefs[board[i] & PIECE_ID];
+		if (def->hasAttackPaths())
+		{
+			if (def->attackPath(IVec2(i & 7, i >> 3), target, board, paths[i])) { candidates |= SQUARE_BB(i); }
+		}
+		else if (pos.attackMap.attacksFrom[i] & SQUARE_BB(move.to()))
+		{
+			paths[i] = 0;
+			candidates |= SQUARE_BB(i);
+		}
+	}
+
+	// Swap list: gain[d] is the material won by the team making capture d if the exchange stops there
+	int gain[32];
+	int d = 0;
+	gain[0] = captured;
+	int team = ((board[move.from()] & PIECE_TEAM) >> 4) ^ 1;
+	while (d < 31)
+	{
+		// Least valuable piece of the team with a clear path to the target
+		int best = -1, bestValue = 0;
+		UINT64 att = candidates & occ & board.teamBB[team];
+		while (att)
+		{
+			int i = popLsb(att);
+			if (paths[i] & occ) { continue; }
+			int v = seeValue(pos, board[i]);
+			if (best < 0 || v < bestValue)
+			{
+				best = i;
+				bestValue = v;
+			}
+		}
+		if (best < 0) { break; }
+		d++;
+		gain[d] = attacker - gain[d - 1];
+		attacker = bestValue;
+		occ &= ~SQUARE_BB(best);
+		team ^= 1;
+	}
+	// Each team stops the exchange when capturing again loses material
+	for (; d > 0; d--)
+	{
+		if (gain[d] > -gain[d - 1]) { gain[d - 1] = -gain[d]; }
+	}
+	return gain[0];
+}
@@ -0,0 +1,227 @@
+#pragma once
+#include "Platform.h"
+#include <vector>
+#include "Bitboard.h"
+
+// PEXT is used to index the tables when the target supports BMI2,
+// otherwise the classic magic multiplication is used. The 64 bit PEXT only
+// exists on 64 bit targets (MSVC defines __AVX2__ for x86 with /arch:AVX2 too).
+#if (defined(__BMI2__) || defined(__AVX2__)) && !(defined(_MSC_VER) && !defined(_M_X64))
+#include <immintrin.h>
+#define SLIDING_USE_PEXT
+#endif
+
+// Maximum amount of occupancy bits per table before directions are split into groups
+#define SLIDING_GROUP_BITS 12
+// Amount of magics tried before a table is given an extra index bit
+#define SLIDING_MAGIC_TRIES 20000
+
+// Magic multiplier and shift of a group of directions of a square, found by an earlier
+// build (see SlidingAttacks::magics). Known magics spare the search when the tables
+// are built, and are ignored with PEXT.
+struct SlidingMagic
+{
+	UINT64 magic;
+	int shift;
+};
+
+// Attack tables of a sliding piece, indexed by occupancy.
+// The directions of the piece (subtrees of its moveset) are grouped so that
+// each group has at most SLIDING_GROUP_BITS relevant occupancy bits. Rooks and
+// bishops always fit in one group, so their attack set is a single lookup.
+class SlidingAttacks
+{
+private:
+	// Table lookup data for a group of directions
+	struct Group
+	{
+		UINT64 mask;	// Relevant occupancy squares
+		UINT64 magic;	// Magic multiplier (unused with PEXT)
+		int shift;		// Right shift of the magic product
+		int offset;		// Offset of the group in the attack table
+	};
+
+	std::vector<Group> groups;		// Groups of every square
+	int groupStart[65];				// Index of the first group of each square
+	std::vector<UINT64> table;		// Attack sets of all groups
+
+	// Simple xorshift generator used to find magics (deterministic)
+	UINT64 seed;
+	UINT64 random()
+	{
+		seed ^= seed >> 12;
+		seed ^= seed << 25;
+		seed ^= seed >> 27;
+		return seed * 2685821657736338717ULL;
+	}
+
+	// Get the index of an occupancy inside the table of a group
+	static int index(const Group& g, UINT64 occ)
+	{
+#ifdef SLIDING_USE_PEXT
+		return g.offset + (int)_pext_u64(occ, g.mask);
+#else
+		return g.offset + (int)(((occ & g.mask) * g.magic) >> g.shift);
+#endif
+	}
+
+	// Compute the attack set of a group using the shadow bitboards
+	static UINT64 slowAttacks(UINT64 reach, const UINT64* shadows, UINT64 occ)
+	{
+		UINT64 att = reach;
+		UINT64 blockers = reach & occ;
+		while (blockers) { att &= ~shadows[popLsb(blockers)]; }
+		return att;
+	}
+
+	// Fill the table of a group, finding a magic if PEXT is not available. A known magic
+	// is tried first, and searched past if it doesn't fit the group.
+	void fillGroup(Group& g, UINT64 reach, const UINT64* shadows, const SlidingMagic* known)
+	{
+		int bits = popCount(g.mask);
+		int size = 1 << bits;
+		// Enumerate all occupancy subsets of the mask (carry-rippler)
+		std::vector<UINT64> occs(size), atts(size);
+		UINT64 sub = 0;
+		for (int i = 0; i < size; i++)
+		{
+			occs[i] = sub;
+			atts[i] = slowAttacks(reach, shadows, sub);
+			sub = (sub - g.mask) & g.mask;
+		}
+		g.offset = (int)table.size();
+		g.shift = 64 - bits;
+		g.magic = 0;
+#ifndef SLIDING_USE_PEXT
+		if (bits == 0)
+		{	// Single entry, avoid the undefined 64 bit shift
+			g.shift = 63;
+			table.push_back(atts[0]);
+			return;
+		}
+		// Try sparse random magics until none of the occupancies collide destructively.
+		// Masks which do not lie on a single line can be hard to fit, so the table is
+		// given an extra index bit every SLIDING_MAGIC_TRIES failed attempts.
+		int tblSize = size;
+		table.resize(table.size() + tblSize);
+		std::vector<int> epoch(tblSize, 0);
+		if (known != NULL && known->shift <= g.shift && known->shift > g.shift - 4)
+		{
+			g.shift = known->shift;
+			tblSize = 1 << (64 - g.shift);
+			table.resize(g.offset + tblSize);
+			epoch.assign(tblSize, 0);
+		}
+		else { known = NULL; }
+		for (int tries = 1; ; tries++)
+		{
+			if (tries == 1 && known != NULL) { g.magic = known->magic; }
+			else
+			{
+				if (tries % SLIDING_MAGIC_TRIES == 0)
+				{
+					g.shift--;
+					tblSize *= 2;
+					table.resize(g.offset + tblSize);
+					epoch.assign(tblSize, 0);
+				}
+				g.magic = random() & random() & random();
+				// Skip magics which do not spread large masks to the top bits
+				if (bits > 6 && popCount((g.mask * g.magic) & 0xFF00000000000000ULL) < 6) { continue; }
+			}
+			bool ok = true;
+			for (int i = 0; i < size && ok; i++)
+			{
+				int j = index(g, occs[i]);
+				if (epoch[j - g.offset] != tries)
+				{
+					epoch[j - g.offset] = tries;
+					table[j] = atts[i];
+				}
+				else ok = table[j] == atts[i];
+			}
+			if (ok) { return; }
+		}
+#else
+		table.resize(table.size() + size);
+		for (int i = 0; i < size; i++) { table[index(g, occs[i])] = atts[i]; }
+#endif
+	}
+
+public:
+	SlidingAttacks() : groupStart{ }, seed(0x9E3779B97F4A7C15ULL) {};
+
+	// Build the tables. reach[sqr] holds the squares reachable on an empty board
+	// and shadows[64*from + sqr] the squares hidden by sqr, as computed by UnitMovePiece.
+	// firstStep[64*from + sqr] gives the first square on the path to sqr, used
+	// to group the squares by direction. magics holds magicCount known magics of the
+	// groups in order (see magics), if any.
+	void build(const UINT64* reach, const UINT64* shadows, const byte* firstStep, const SlidingMagic* magics = NULL, int magicCount = 0)
+	{
+		groups.clear();
+		table.clear();
+		for (int from = 0; from < 64; from++)
+		{
+			groupStart[from] = (int)groups.size();
+			const UINT64* sh = shadows + 64 * from;
+			// Gather each direction's reach and relevant occupancy
+			UINT64 dirReach[64] = { }, dirMask[64] = { };
+			UINT64 r = reach[from];
+			while (r)
+			{
+				int sqr = popLsb(r);
+				int d = firstStep[64 * from + sqr];
+				dirReach[d] |= SQUARE_BB(sqr);
+				if (sh[sqr] != 0) { dirMask[d] |= SQUARE_BB(sqr); }
+			}
+			// Greedily pack directions into groups
+			Group g = { 0, 0, 0, 0 };
+			UINT64 gReach = 0;
+			for (int d = 0; d < 64; d++)
+			{
+				if (dirReach[d] == 0) { continue; }
+				if (gReach != 0 && popCount(g.mask | dirMask[d]) > SLIDING_GROUP_BITS)
+				{
+					fillGroup(g, gReach, sh, (int)groups.size() < magicCount ? &magics[groups.size()] : NULL);
+					groups.push_back(g);
+					g = { 0, 0, 0, 0 };
+					gReach = 0;
+				}
+				g.mask |= dirMask[d];
+				gReach |= dirReach[d];
+			}
+			if (gReach != 0)
+			{
+				fillGroup(g, gReach, sh, (int)groups.size() < magicCount ? &magics[groups.size()] : NULL);
+				groups.push_back(g);
+			}
+		}
+		groupStart[64] = (int)groups.size();
+	}
+
+	// Get the attack set from a square for a given board occupancy.
+	UINT64 attacks(int from, UINT64 occ) const
+	{
+		UINT64 att = 0;
+		for (int i = groupStart[from]; i < groupStart[from + 1]; i++)
+		{
+			att |= table[index(groups[i], occ)];
+		}
+		return att;
+	}
+
+	// Get the magics of the groups in order, to build the same tables again without
+	// searching (see StandardMagics.h)
+	std::vector<SlidingMagic> magics() const
+	{
+		std::vector<SlidingMagic> out;
+		for (const Group& g : groups) { out.push_back(SlidingMagic{ g.magic, g.shift }); }
+		return out;
+	}
+
+	// Total amount of table entries
+	size_t size() const
+	{
+		return table.size();
+	}
+};
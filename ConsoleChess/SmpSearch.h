@@ -0,0 +1,131 @@
+#pragma once
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "Platform.h"
+#include "Position.h"
+#include "Search.h"
+#include "TranspositionTable.h"
+
+// Parallel search in the Lazy SMP style: every thread runs its own Search of the same
+// root position, with its own position stack and tables, and all of them share one
+// transposition table. The threads don't split the tree, they speed each other up
+// through the entries they store. Helper threads skip some depths (see Search::skipDepth)
+// so they don't search the same trees in step with the main thread. When the main thread
+// is done the helpers are stopped, and the threads vote for the move to play.
+class SmpSearch
+{
+private:
+	std::vector<std::unique_ptr<Search>> searches; // Search of each thread, the main one first
+
+	// Pick the move voted by the threads. Each thread votes for the best move of its last
+	// completed iteration, with a weight growing with the depth and the score above the
+	// worst score. Sets info to the result of the deepest thread voting for the move.
+	SearchMove vote()
+	{
+		Search& main = *searches[0];
+		info = main.info;
+		if (searches.size() == 1) { return main.bestMove; }
+
+		int minScore = SCORE_INFINITE;
+		for (auto& s : searches)
+		{
+			if (s->info.depth > 0 && s->info.score < minScore) { minScore = s->info.score; }
+		}
+		std::vector<SearchMove> moves;
+		std::vector<long long> votes;
+		for (auto& s : searches)
+		{
+			if (s->info.depth == 0 || s->info.pvLength == 0) { continue; }
+			SearchMove m = s->info.pv[0];
+			size_t i = 0;
+			while (i < moves.size() && !(moves[i] == m)) { i++; }
+			if (i == moves.size())
+			{
+				moves.push_back(m);
+				votes.push_back(0);
+			}
+			votes[i] += (long long)(s->info.score - minScore + 14) * s->info.depth;
+		}
+		UINT64 nodes = 0;
+		for (auto& s : searches) { nodes += s->info.nodes; }
+		if (moves.empty())
+		{	// No thread completed an iteration
+			info.nodes = nodes;
+			return main.bestMove;
+		}
+
+		size_t best = 0;
+		for (size_t i = 1; i < moves.size(); i++)
+		{
+			if (votes[i] > votes[best]) { best = i; }
+		}
+		int bestDepth = -1;
+		for (auto& s : searches)
+		{
+			if (s->info.depth > bestDepth && s->info.pvLength > 0 && s->info.pv[0] == moves[best])
+			{
+				bestDepth = s->info.depth;
+				info = s->info;
+			}
+		}
+		info.nodes = nodes;
+		info.seconds = main.info.seconds;
+		return moves[best];
+	}
+
+public:
+	TranspositionTable* tt;	// Table shared by the threads, or NULL
+	SearchInfo info;		// Result of the last search, with the nodes of every thread
+	std::function<void(const SearchInfo&)> onIteration; // Called after each iteration of the main thread
+
+	// Create parallel search with a thread count, using a transposition table
+	SmpSearch(TranspositionTable* tt, int threads = 1) : tt(tt), info()
+	{
+		setThreads(threads);
+	}
+
+	// Change the amount of threads (at least 1). Not allowed during a search.
+	void setThreads(int threads)
+	{
+		searches.clear();
+		for (int i = 0; i < (threads > 0 ? threads : 1); i++)
+		{
+			searches.push_back(std::unique_ptr<Search>(new Search(tt)));
+			searches[i]->thread = i;
+		}
+	}
+
+	// Get the amount of threads
+	int threads() const
+	{
+		return (int)searches.size();
+	}
+
+	// Find the best move of a position within a time budget in ms, searching at most
+	// maxDepth plies with the main thread. Returns the null move if the team to move has
+	// no legal moves.
+	SearchMove think(const Position& root, long long timeMs, int maxDepth = MAX_PLY - 1)
+	{
+		if (tt != NULL) { tt->newSearch(); }
+		for (auto& s : searches) { s->start(root, timeMs); }
+		searches[0]->onIteration = onIteration;
+		std::vector<std::thread> pool;
+		for (size_t i = 1; i < searches.size(); i++)
+		{
+			pool.push_back(std::thread(&Search::iterate, searches[i].get(), maxDepth));
+		}
+		searches[0]->iterate(maxDepth);
+		// The main thread is done, stop the helpers
+		for (auto& s : searches) { s->stop(); }
+		for (auto& t : pool) { t.join(); }
+		return vote();
+	}
+
+	// Abort the current search from another thread. think() returns the best move so far.
+	void stop()
+	{
+		for (auto& s : searches) { s->stop(); }
+	}
+};
@@ -0,0 +1,105 @@
+#pragma once
+#include "SlidingAttacks.h"
+
+// Magics of the sliding attack tables of the standard movesets (see StandardPieces.h), in
+// the order of their groups, so builds without PEXT don't search for them at startup.
+// Printed by "bench magics -print" from the tables built by searching.
+
+constexpr SlidingMagic BishopMagics[64] =
+{
+	{ 0x10102002004A1420ULL, 58 }, { 0x0020010224910040ULL, 59 }, { 0x4090008A00C0288CULL, 59 },
+	{ 0x0008218124020100ULL, 59 }, { 0x4002021000100000ULL, 59 }, { 0x8C01100210802300ULL, 59 },
+	{ 0x80140A0104221010ULL, 59 }, { 0x484010880B082002ULL, 58 }, { 0x0A035A1808008401ULL, 59 },
+	{ 0x4030200404A18102ULL, 59 }, { 0x4180040800890080ULL, 59 }, { 0x9B51A40409801400ULL, 59 },
+	{ 0x3000040420002002ULL, 59 }, { 0x2200608805402048ULL, 59 }, { 0x00660201822030C6ULL, 59 },
+	{ 0x0000288048029000ULL, 59 }, { 0x100500A08C100200ULL, 59 }, { 0x0204000810040050ULL, 59 },
+	{ 0x8042023000820008ULL, 57 }, { 0x0000C12802002AC4ULL, 56 }, { 0x5002000400940C02ULL, 57 },
+	{ 0x0921002201010140ULL, 57 }, { 0x0289400924100400ULL, 59 }, { 0x0081004605008200ULL, 59 },
+	{ 0x52AC218040030400ULL, 59 }, { 0x10080CA402100200ULL, 59 }, { 0x0008041208003020ULL, 57 },
+	{ 0x8440040000410020ULL, 54 }, { 0x80F084000A802000ULL, 55 }, { 0x018041000200A200ULL, 57 },
+	{ 0x04240C0011010544ULL, 59 }, { 0x40040888004200A0ULL, 59 }, { 0x1090222A00105010ULL, 59 },
+	{ 0x0004010400181002ULL, 59 }, { 0x024A104410080808ULL, 57 }, { 0x120610404040A002ULL, 54 },
+	{ 0x0002005040101044ULL, 54 }, { 0x42200805C08A8050ULL, 57 }, { 0x060840811C040108ULL, 59 },
+	{ 0x00308104C8050400ULL, 59 }, { 0x0402081340001800ULL, 59 }, { 0x2209011042009000ULL, 59 },
+	{ 0xD005004022181010ULL, 57 }, { 0x0040824010400200ULL, 57 }, { 0x8000240094004204ULL, 57 },
+	{ 0x8020200A40410283ULL, 57 }, { 0x0002048422800400ULL, 59 }, { 0x001001004100CC91ULL, 59 },
+	{ 0x0450880802100000ULL, 59 }, { 0x4084640208042810ULL, 59 }, { 0x8003084C0C040C63ULL, 59 },
+	{ 0x0080008294040008ULL, 59 }, { 0x40400910A2020200ULL, 59 }, { 0x0400093003020011ULL, 59 },
+	{ 0x1210213524048000ULL, 59 }, { 0x0820410401004A00ULL, 59 }, { 0x3013202404200800ULL, 58 },
+	{ 0x0820950402110488ULL, 59 }, { 0x0080001040443014ULL, 59 }, { 0x8000000000208802ULL, 59 },
+	{ 0x1200221004209200ULL, 59 }, { 0x2400102005313A00ULL, 59 }, { 0x00000802104C1911ULL, 59 },
+	{ 0xA4C1C20202002100ULL, 58 }
+};
+
+constexpr SlidingMagic RookMagics[64] =
+{
+	{ 0x00A4040400800040ULL, 50 }, { 0x0020400011000425ULL, 51 }, { 0x022000B821004400ULL, 52 },
+	{ 0x0410028100201000ULL, 52 }, { 0x0901084800008008ULL, 51 }, { 0x84080400010002A0ULL, 52 },
+	{ 0x0012000042801900ULL, 52 }, { 0x1008002000920080ULL, 51 }, { 0x0600800058C00363ULL, 52 },
+	{ 0x0020080090200408ULL, 53 }, { 0x0000800880A00530ULL, 53 }, { 0x4041000410010028ULL, 53 },
+	{ 0x4280400400020040ULL, 53 }, { 0xC002100421021072ULL, 53 }, { 0x0080422400800106ULL, 53 },
+	{ 0x00502013A0A00043ULL, 52 }, { 0x0004100208009044ULL, 52 }, { 0xC100904804010040ULL, 53 },
+	{ 0x1084801800201040ULL, 53 }, { 0x040400300088100AULL, 53 }, { 0x00050A0010020022ULL, 53 },
+	{ 0x40411A0012001001ULL, 53 }, { 0x4004340021100218ULL, 54 }, { 0x0022808005421121ULL, 52 },
+	{ 0x0004010400800040ULL, 52 }, { 0x0428009010024020ULL, 53 }, { 0xC020200080100080ULL, 54 },
+	{ 0x0044010010080200ULL, 53 }, { 0x000A000208000400ULL, 53 }, { 0x20062A0080014418ULL, 53 },
+	{ 0x0000101A10020004ULL, 53 }, { 0x00A0004080002100ULL, 52 }, { 0x0880002000C00010ULL, 52 },
+	{ 0x00C0001050802000ULL, 53 }, { 0x8010000A00200020ULL, 53 }, { 0x2201402012000408ULL, 53 },
+	{ 0x8002009042000660ULL, 53 }, { 0x0802001002000804ULL, 54 }, { 0x0000320000800100ULL, 53 },
+	{ 0x0880004102002084ULL, 53 }, { 0x1050800040008028ULL, 53 }, { 0x1816A02040802018ULL, 53 },
+	{ 0x1004220801022000ULL, 53 }, { 0x041090002D100200ULL, 53 }, { 0x0208008426202020ULL, 53 },
+	{ 0x0800200200406001ULL, 53 }, { 0x2005060013118020ULL, 53 }, { 0x0120014A03100120ULL, 52 },
+	{ 0x000480284A010200ULL, 53 }, { 0x0140148440200080ULL, 54 }, { 0x0000E08008002028ULL, 53 },
+	{ 0x0200801000080080ULL, 54 }, { 0x0100040002004040ULL, 53 }, { 0x088C000300080100ULL, 53 },
+	{ 0x0100021400800130ULL, 53 }, { 0x0085020820800440ULL, 52 }, { 0x020842001180200AULL, 51 },
+	{ 0x0000200851004202ULL, 52 }, { 0x0241004204200011ULL, 52 }, { 0x0100204200100402ULL, 52 },
+	{ 0x0100010200A00812ULL, 52 }, { 0x4A01002E08058441ULL, 52 }, { 0x4400004328009004ULL, 52 },
+	{ 0x500000401681040AULL, 51 }
+};
+
+constexpr SlidingMagic QueenMagics[128] =
+{
+	{ 0x00A4040400800040ULL, 50 }, { 0x0008080808142820ULL, 58 }, { 0x0140400100201088ULL, 51 },
+	{ 0x000C100401102010ULL, 59 }, { 0x0020000400200800ULL, 52 }, { 0x8608061A82040800ULL, 60 },
+	{ 0x0200880008400008ULL, 57 }, { 0x0241040010080020ULL, 54 }, { 0x2200209008C10004ULL, 56 },
+	{ 0x0004001008810020ULL, 55 }, { 0x0220420080410190ULL, 54 }, { 0x0A00210402008010ULL, 57 },
+	{ 0x02000410008020C0ULL, 54 }, { 0x0000210085421200ULL, 58 }, { 0x000A000402021080ULL, 51 },
+	{ 0x002302A08030408AULL, 58 }, { 0x3020C00140200012ULL, 52 }, { 0x2820040802040400ULL, 59 },
+	{ 0x0002002600844101ULL, 54 }, { 0x0000029801040A80ULL, 59 }, { 0x0000200088412024ULL, 52 },
+	{ 0x0000112C26808800ULL, 60 }, { 0x5000022190002050ULL, 50 }, { 0x000405111A001080ULL, 61 },
+	{ 0x2022002801001000ULL, 56 }, { 0x2880004100220010ULL, 56 }, { 0x0002000420A01408ULL, 54 },
+	{ 0x8000218042040420ULL, 58 }, { 0x0001000400200020ULL, 54 }, { 0x0000291042002980ULL, 59 },
+	{ 0x844004808400C0A0ULL, 52 }, { 0x0841025021008240ULL, 59 }, { 0x20C0002000100025ULL, 52 },
+	{ 0x2000004004080200ULL, 60 }, { 0x00010B0040008100ULL, 52 }, { 0x1041148444940C00ULL, 60 },
+	{ 0x0090004080220100ULL, 55 }, { 0x9040012088020041ULL, 56 }, { 0x2004002040020804ULL, 54 },
+	{ 0x000800010C008805ULL, 57 }, { 0x40C0080082400000ULL, 52 }, { 0x0800000204480084ULL, 58 },
+	{ 0x0004800800010080ULL, 51 }, { 0x1020008208811042ULL, 59 }, { 0x1020050008005000ULL, 53 },
+	{ 0x0004000202810040ULL, 60 }, { 0x0100110004002201ULL, 51 }, { 0x0080000040208103ULL, 60 },
+	{ 0x030C910200040000ULL, 54 }, { 0x00181430C0242104ULL, 58 }, { 0x0405A00504004020ULL, 50 },
+	{ 0x1002820D38108C49ULL, 61 }, { 0x00A0100440010006ULL, 53 }, { 0x0005044008024400ULL, 58 },
+	{ 0xA240070700001200ULL, 52 }, { 0x0220000208008108ULL, 56 }, { 0x8020043800810020ULL, 52 },
+	{ 0xC030380044010420ULL, 56 }, { 0x0011020040000184ULL, 54 }, { 0x4804441086012080ULL, 57 },
+	{ 0xA200040048044400ULL, 51 }, { 0x2248221002B30600ULL, 61 }, { 0x1404108200000802ULL, 54 },
+	{ 0x20802A0003084100ULL, 58 }, { 0x00100020248E4100ULL, 51 }, { 0x480020C1002084C1ULL, 60 },
+	{ 0x8400180208020068ULL, 52 }, { 0x0488080000104608ULL, 60 }, { 0x0102000A00280510ULL, 51 },
+	{ 0x1040010802082080ULL, 59 }, { 0x00022010104040A0ULL, 53 }, { 0x81010028000800A0ULL, 54 },
+	{ 0x540C000601808020ULL, 52 }, { 0x0001004000180830ULL, 55 }, { 0x2400040401002480ULL, 51 },
+	{ 0x08000850404A0188ULL, 59 }, { 0x000802021A100200ULL, 52 }, { 0x30000008E0011840ULL, 60 },
+	{ 0x0802208404400400ULL, 51 }, { 0x0001004008112100ULL, 60 }, { 0x8124008201080400ULL, 55 },
+	{ 0xC0C3012040020102ULL, 56 }, { 0x0004020800801040ULL, 56 }, { 0x0010200108042000ULL, 57 },
+	{ 0x0400C00418100010ULL, 52 }, { 0x8122A00080020100ULL, 57 }, { 0x000080080404000CULL, 51 },
+	{ 0x0004000040420102ULL, 58 }, { 0x8466828020800200ULL, 50 }, { 0x80012221002A0100ULL, 59 },
+	{ 0xE042040108040000ULL, 54 }, { 0x02C8090860880420ULL, 56 }, { 0x0800802042000020ULL, 56 },
+	{ 0x8301040400810200ULL, 57 }, { 0x0000408020022481ULL, 55 }, { 0x0020488002020084ULL, 56 },
+	{ 0x200C080040200108ULL, 52 }, { 0x3200400010081040ULL, 58 }, { 0x1021104008001004ULL, 53 },
+	{ 0x0102000212010208ULL, 59 }, { 0x0000420004005000ULL, 51 }, { 0x818004801C008600ULL, 60 },
+	{ 0x0008001000280400ULL, 51 }, { 0x1000000804200200ULL, 61 }, { 0x10C8502080400C02ULL, 53 },
+	{ 0x00260200A0481206ULL, 59 }, { 0x0800420011080800ULL, 53 }, { 0x0000040020405820ULL, 59 },
+	{ 0x4400090282000800ULL, 52 }, { 0x0042051010200400ULL, 59 }, { 0x2001002004010000ULL, 52 },
+	{ 0x08000900B8002200ULL, 58 }, { 0x010100C008042000ULL, 50 }, { 0x8000004000212002ULL, 58 },
+	{ 0x201040C200040008ULL, 51 }, { 0x008000000A010002ULL, 59 }, { 0x2002511802004001ULL, 50 },
+	{ 0x401200C882000222ULL, 60 }, { 0x0100102004084800ULL, 52 }, { 0x120212200401008AULL, 59 },
+	{ 0x0048180040100102ULL, 52 }, { 0x0040010020089012ULL, 59 }, { 0x8000110204002001ULL, 51 },
+	{ 0x8002002100002022ULL, 59 }, { 0x0006200050009880ULL, 52 }, { 0x22020400C0180221ULL, 59 },
+	{ 0x0000110040808020ULL, 50 }, { 0x0001201481421141ULL, 58 }
+};
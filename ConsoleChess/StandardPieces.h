@@ -0,0 +1,80 @@
+#pragma once
+#include <vector>
+
+#include "Platform.h"
+#include "BoardState.h"
+#include "UnitMovePiece.h"
+#include "StandardMagics.h"
+#include "SpriteDefs.h"
+#include "Pawn.h"
+#include "King.h"
+
+// Unit moves of the standard pieces
+constexpr IVec2 DiagonalMove[] = { IVec2(1, 1) };
+constexpr IVec2 KnightMove[] = { IVec2(2, 1) };
+constexpr IVec2 StraightMove[] = { IVec2(1, 0) };
+
+// Movesets of the standard pieces, built when compiling
+constexpr UnitMoveset BishopMoveset = makeUnitMoveset(DiagonalMove, 1, Rotate90, true, false);
+constexpr UnitMoveset KnightMoveset = makeUnitMoveset(KnightMove, 1, Rotate90 | FlipY, false, true);
+constexpr UnitMoveset RookMoveset = makeUnitMoveset(StraightMove, 1, Rotate90, true, false);
+constexpr UnitMoveset QueenMoveset = makeUnitMoveset(StraightMove, 1, Rotate45, true, false);
+
+// Piece definitions of standard chess, shared by the game and the command line tools.
+struct StandardPieces
+{
+	Pawn pawn;				// Pawn definition
+	UnitMovePiece bishop;	// Bishop definition
+	UnitMovePiece knight;	// Knight definition
+	UnitMovePiece rook;		// Rook definition
+	UnitMovePiece queen;	// Queen definition
+	King king;				// King definition
+
+	// Create the standard pieces and generate their movesets
+	StandardPieces() :
+		pawn(1, PawnSprite),
+		bishop(2, false, false, BishopSprite),
+		knight(3, false, true, KnightSprite),
+		rook(4, false, false, RookSprite),
+		queen(5, false, false, QueenSprite),
+		king(6, 4, KingSprite)
+	{
+		bishop.setMoveset(BishopMoveset, BishopMagics);
+		knight.setMoveset(KnightMoveset);
+		rook.setMoveset(RookMoveset, RookMagics);
+		queen.setMoveset(QueenMoveset, QueenMagics);
+		// Material values, the king can't be captured so it has none
+		pawn.value = 100;
+		bishop.value = 330;
+		knight.value = 320;
+		rook.value = 500;
+		queen.value = 900;
+	}
+
+	// Holds pointers to its members, so it can't be copied
+	StandardPieces(const StandardPieces&) = delete;
+	StandardPieces& operator=(const StandardPieces&) = delete;
+
+	// Get the vector of PieceDef pointers
+	std::vector<PieceDef*> list()
+	{
+		return std::vector<PieceDef*> { &pawn, &bishop, &knight, &rook, &queen, &king };
+	}
+
+	// Get the initial chess position
+	static BoardState startingBoard()
+	{
+		static byte data[64] =
+		{
+			0x04, 0x03, 0x02, 0x05, 0x06, 0x02, 0x03, 0x04,
+			0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01,
+			0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+			0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+			0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+			0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+			0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+			0x14, 0x13, 0x12, 0x15, 0x16, 0x12, 0x13, 0x14
+		};
+		return BoardState(data);
+	}
+};
@@ -0,0 +1,406 @@
+#pragma once
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Platform.h"
+#include "BoardState.h"
+#include "PieceDef.h"
+#include "Position.h"
+#include "Fen.h"
+#include "MappedFile.h"
+
+#define TB_MAX_PIECES 5			// Most pieces of a table, kings included
+#define TB_VERSION 2			// Version of the table file layout
+#define TB_DEFAULT_PATH "tb"	// Folder of the tables loaded by the game
+#define TB_EXTENSION ".cctb"	// Extension of the table files
+#define TB_INVALID 255			// Value of the indices which aren't a legal canonical position
+#define TB_MAX_DISTANCE 253		// Longest distance to mate a table can hold, in plies
+
+// Endgame tablebases: the result of every position of a material with the best play of
+// both teams, found by retrograde analysis (see the TbGen tool). Each position of a table
+// has one byte: 0 for a draw, else the distance to mate in plies + 1. Even distances are
+// losses for the team to move (0 is checkmated), odd ones are wins.
+//
+// Tables have no castling rights and en passant captures (only one team can have pawns),
+// every piece has moved except the irreversible pieces (pawns) on their initial rank. The
+// positions of the material are reduced by the symmetries of the board its pieces move the
+// same under (the mirrors and the diagonal flip), found when generating and kept in the
+// table header, and only the placements of the critical pieces which can be legal are kept.
+
+// Symmetries of the board, bit 0 mirrors the files, bit 1 the ranks and bit 2 flips the
+// board on its diagonal (first, swapping files and ranks)
+inline int tbTransform(int t, int sqr)
+{
+	int x = sqr & 7, y = sqr >> 3;
+	if (t & 4)
+	{
+		int tmp = x;
+		x = y;
+		y = tmp;
+	}
+	if (t & 1) { x = 7 - x; }
+	if (t & 2) { y = 7 - y; }
+	return y << 3 | x;
+}
+
+// Byte a piece has on a square of a table: every piece has moved, except irreversible
+// pieces (pawns) on their initial rank
+inline byte tbPieceByte(PieceDef* const* defs, byte piece, int sqr)
+{
+	piece &= PIECE_ID | PIECE_TEAM;
+	int initialRank = (piece & PIECE_TEAM) ? 6 : 1;
+	if (defs[piece & PIECE_ID]->irreversible && (sqr >> 3) == initialRank) { return piece; }
+	return piece | PIECE_MOVED;
+}
+
+// Result of a position in the tables
+struct TbResult
+{
+	int wdl;		// 1 if the team to move wins, -1 if it loses, 0 for a draw
+	int distance;	// Plies to mate with the best play, 0 for a draw
+
+	// Read the value of a position. Returns false for invalid positions.
+	static bool fromValue(byte v, TbResult& out)
+	{
+		if (v == TB_INVALID) { return false; }
+		int d = v - 1;
+		out = TbResult{ v == 0 ? 0 : (d & 1) ? 1 : -1, v == 0 ? 0 : d };
+		return true;
+	}
+};
+
+// Pieces of a table: white pieces first, then by decreasing ID
+struct TbMaterial
+{
+	int count;
+	byte pieces[TB_MAX_PIECES]; // Piece IDs with their team flag
+
+	// Sort pieces into material order, along with their squares. The squares of identical
+	// pieces end up in increasing order.
+	static void sort(byte* pieces, byte* squares, int n)
+	{
+		for (int i = 1; i < n; i++)
+		{
+			for (int j = i; j > 0; j--)
+			{
+				int a = pieces[j - 1], b = pieces[j];
+				bool before = (a & PIECE_TEAM) != (b & PIECE_TEAM) ? (b & PIECE_TEAM) != 0 :
+					(a & PIECE_ID) != (b & PIECE_ID) ? (b & PIECE_ID) > (a & PIECE_ID) : squares[j] < squares[j - 1];
+				if (!before) { break; }
+				std::swap(pieces[j - 1], pieces[j]);
+				std::swap(squares[j - 1], squares[j]);
+			}
+		}
+	}
+
+	// Name of the material with piece letters indexed by ID - 1, ex. "KQvK"
+	std::string name(const char* letters = STANDARD_PIECE_LETTERS) const
+	{
+		std::string s;
+		for (int team = 1; team >= 0; team--)
+		{
+			if (team == 0) { s += 'v'; }
+			for (int i = 0; i < count; i++)
+			{
+				if (((pieces[i] & PIECE_TEAM) != 0) == (team == 1)) { s += (char)toupper(letters[(pieces[i] & PIECE_ID) - 1]); }
+			}
+		}
+		return s;
+	}
+
+	// Parse a material name. Returns false if it is malformed or has too many pieces.
+	static bool parse(const std::string& name, TbMaterial& out, const char* letters = STANDARD_PIECE_LETTERS)
+	{
+		std::string letterStr = std::string(letters);
+		byte squares[TB_MAX_PIECES] = { };
+		out.count = 0;
+		int team = 1;
+		for (char c : name)
+		{
+			if (c == 'v' && team == 1)
+			{
+				team = 0;
+				continue;
+			}
+			size_t id = letterStr.find((char)tolower(c));
+			if (id == std::string::npos || out.count == TB_MAX_PIECES) { return false; }
+			out.pieces[out.count++] = (byte)(id + 1) | (team ? PIECE_TEAM : 0);
+		}
+		if (team == 1) { return false; }
+		sort(out.pieces, squares, out.count);
+		return true;
+	}
+
+	// Same material with the teams swapped
+	TbMaterial swapped() const
+	{
+		TbMaterial m = *this;
+		byte squares[TB_MAX_PIECES] = { };
+		for (int i = 0; i < count; i++) { m.pieces[i] ^= PIECE_TEAM; }
+		sort(m.pieces, squares, count);
+		return m;
+	}
+};
+
+// Header of a table file, followed by the square pairs of the critical pieces (the square
+// of the white one, then of the black one) and the value of each position
+struct TbHeader
+{
+	char magic[4];					// "CCTB"
+	int version;					// TB_VERSION
+	int count;						// Amount of pieces
+	byte pieces[8];					// Pieces in material order
+	int crits[2];					// Index of the critical piece of each team in the material
+	int symmetries;					// Bit of each board transform (see tbTransform) the table is reduced by
+	int maxDistance;				// Longest distance to mate of the table
+	int pairs;						// Amount of square pairs of the critical pieces
+	UINT64 domains[TB_MAX_PIECES];	// Squares each piece can stand on
+	UINT64 size;					// Amount of positions
+};
+
+// Table of a material, on a memory mapped file or on memory of its own while it is generated.
+// Positions are indexed by the team to move, then the squares of the two critical pieces,
+// among the pairs which represent their symmetries and can be legal (the pieces don't both
+// attack each other, ex. kings side by side), then the square of each other piece among
+// the squares it can stand on.
+class Tablebase
+{
+private:
+	std::vector<byte> pairSquares;		// Squares of the white and black critical pieces of each pair
+	std::vector<int> pairIndex;			// Index of each pair of squares (white * 64 + black), -1 if none
+	byte ranks[TB_MAX_PIECES][64];		// Index of each square among the squares of a piece, 255 if not one
+	byte squaresOf[TB_MAX_PIECES][64];	// Squares each piece can stand on
+	int radix[TB_MAX_PIECES];			// Amount of squares of each piece
+	UINT64 half;						// Positions per team to move
+
+	const byte* data;					// Value of each position
+	std::unique_ptr<MappedFile> file;	// Mapped table file, NULL if the values aren't mapped
+
+public:
+	TbMaterial material;			// Pieces of the table
+	int crits[2];					// Index of the critical piece of each team in the material
+	UINT64 domains[TB_MAX_PIECES];	// Squares each piece can stand on
+	int symmetries;					// Transforms the table is reduced by, bit 0 for the identity
+	int maxDistance;				// Longest distance to mate
+
+	// Create table of a material without values. The pairs are the square pairs of the
+	// critical pieces (white then black) indexed by the table.
+	Tablebase(const TbMaterial& material, const int* crits, const UINT64* domains, int symmetries, const std::vector<byte>& pairs) :
+		pairSquares(pairs), pairIndex(64 * 64, -1), data(NULL), material(material), crits{ crits[0], crits[1] },
+		symmetries(symmetries | 1), maxDistance(0)
+	{
+		for (int k = 0; k < (int)pairs.size() / 2; k++) { pairIndex[pairs[2 * k] << 6 | pairs[2 * k + 1]] = k; }
+		half = pairs.size() / 2;
+		for (int i = 0; i < material.count; i++)
+		{
+			this->domains[i] = domains[i];
+			radix[i] = 0;
+			for (int sqr = 0; sqr < 64; sqr++)
+			{
+				ranks[i][sqr] = 255;
+				if (!(domains[i] & SQUARE_BB(sqr))) { continue; }
+				ranks[i][sqr] = (byte)radix[i];
+				squaresOf[i][radix[i]++] = (byte)sqr;
+			}
+			if (i != crits[0] && i != crits[1]) { half *= radix[i]; }
+		}
+	}
+
+	Tablebase(const Tablebase&) = delete;
+	Tablebase& operator=(const Tablebase&) = delete;
+
+	// Amount of positions of the table
+	UINT64 size() const
+	{
+		return 2 * half;
+	}
+
+	// Use values held elsewhere (ex. by the generator)
+	void setValues(const byte* values)
+	{
+		data = values;
+	}
+
+	// Map a table file. Returns NULL if it is missing or doesn't hold a table.
+	static std::unique_ptr<Tablebase> open(const std::string& path)
+	{
+		std::unique_ptr<MappedFile> file(new MappedFile());
+		if (!file->open(path)) { return NULL; }
+		// Check the header before trusting the sizes
+		const TbHeader* header = (const TbHeader*)file->data();
+		if (file->size() < sizeof(TbHeader) || memcmp(header->magic, "CCTB", 4) != 0 || header->version != TB_VERSION ||
+			header->count < 2 || header->count > TB_MAX_PIECES || header->pairs < 0 || header->pairs > 64 * 64 ||
+			header->crits[0] < 0 || header->crits[0] >= header->count || header->crits[1] < 0 || header->crits[1] >= header->count ||
+			file->size() < sizeof(TbHeader) + 2 * (size_t)header->pairs)
+		{
+			return NULL;
+		}
+		TbMaterial m = TbMaterial{ header->count, { } };
+		memcpy(m.pieces, header->pieces, header->count);
+		const byte* pairs = file->data() + sizeof(TbHeader);
+		std::vector<byte> pairList = std::vector<byte>(pairs, pairs + 2 * header->pairs);
+		for (byte sqr : pairList)
+		{
+			if (sqr >= 64) { return NULL; }
+		}
+		std::unique_ptr<Tablebase> table(new Tablebase(m, header->crits, header->domains, header->symmetries, pairList));
+		table->maxDistance = header->maxDistance;
+		size_t offset = sizeof(TbHeader) + pairList.size();
+		if (header->size != table->size() || file->size() < offset + header->size) { return NULL; }
+		table->data = file->data() + offset;
+		table->file = std::move(file);
+		return table;
+	}
+
+	// Write a table file with the values of the table. Returns false on failure.
+	bool save(const std::string& path) const
+	{
+		std::ofstream file(path, std::ios::binary);
+		TbHeader header = TbHeader{ { 'C', 'C', 'T', 'B' }, TB_VERSION, material.count, { }, { crits[0], crits[1] },
+			symmetries, maxDistance, (int)pairSquares.size() / 2, { }, size() };
+		memcpy(header.pieces, material.pieces, material.count);
+		memcpy(header.domains, domains, material.count * sizeof(UINT64));
+		return file.write((const char*)&header, sizeof(header)) &&
+			file.write((const char*)pairSquares.data(), (std::streamsize)pairSquares.size()) &&
+			file.write((const char*)data, (std::streamsize)size());
+	}
+
+	// Get the index of a position from the squares of the pieces in material order. The
+	// squares are brought to their representative by the symmetries, and when several
+	// transforms do it the smallest index is used, so all the symmetric positions and the
+	// orders of identical pieces share one index. Returns ~0 for positions outside the
+	// table (the critical pieces attacking each other, or a piece off its squares).
+	UINT64 index(const byte* squares, int team) const
+	{
+		UINT64 best = ~0ULL;
+		for (int t = 0; t < 8; t++)
+		{
+			if (!(symmetries >> t & 1)) { continue; }
+			byte sq[TB_MAX_PIECES] = { };
+			byte pieces[TB_MAX_PIECES] = { };
+			for (int i = 0; i < material.count; i++)
+			{
+				sq[i] = (byte)tbTransform(t, squares[i]);
+				pieces[i] = material.pieces[i];
+			}
+			int pair = pairIndex[sq[crits[1]] << 6 | sq[crits[0]]];
+			if (pair < 0) { continue; }
+			TbMaterial::sort(pieces, sq, material.count);
+			UINT64 idx = pair;
+			for (int i = 0; i < material.count && idx != ~0ULL; i++)
+			{
+				if (i == crits[0] || i == crits[1]) { continue; }
+				idx = ranks[i][sq[i]] == 255 ? ~0ULL : idx * radix[i] + ranks[i][sq[i]];
+			}
+			if (idx < best) { best = idx; }
+		}
+		return best == ~0ULL ? best : (team ? half : 0) + best;
+	}
+
+	// Get the squares of the pieces in material order and the team to move of an index
+	void decode(UINT64 idx, byte* squares, int& team) const
+	{
+		team = idx >= half;
+		if (team) { idx -= half; }
+		for (int i = material.count - 1; i >= 0; i--)
+		{
+			if (i == crits[0] || i == crits[1]) { continue; }
+			squares[i] = squaresOf[i][idx % radix[i]];
+			idx /= radix[i];
+		}
+		squares[crits[1]] = pairSquares[2 * idx];
+		squares[crits[0]] = pairSquares[2 * idx + 1];
+	}
+
+	// Value of the position at an index, TB_INVALID outside the table
+	byte value(UINT64 idx) const
+	{
+		return idx < size() ? data[idx] : TB_INVALID;
+	}
+};
+
+// The tables of a folder, opened when first probed. Files are named after their material
+// (ex. "KQvK.cctb", see TbMaterial::name).
+class Tablebases
+{
+private:
+	std::string path;										// Folder of the tables
+	std::string letters;									// Piece letters of the file names
+	std::map<std::string, std::unique_ptr<Tablebase>> tables;// Tables opened so far
+
+public:
+	Tablebases() : path(TB_DEFAULT_PATH), letters(STANDARD_PIECE_LETTERS) {};
+
+	// Set the folder of the tables and the letters of the pieces in their names, indexed by ID - 1.
+	// Closes the tables opened so far.
+	void setPath(const std::string& folder, const char* pieceLetters = STANDARD_PIECE_LETTERS)
+	{
+		path = folder;
+		letters = pieceLetters;
+		tables.clear();
+	}
+
+	// Path of the file of a material
+	std::string fileOf(const TbMaterial& m) const
+	{
+		return path + "/" + m.name(letters.c_str()) + TB_EXTENSION;
+	}
+
+	// Get the table of a material, opening its file the first time. Returns NULL if there is
+	// none. Opening isn't thread safe, the generator opens the tables it needs beforehand.
+	const Tablebase* find(const TbMaterial& m)
+	{
+		std::string name = m.name(letters.c_str());
+		auto it = tables.find(name);
+		if (it != tables.end()) { return it->second.get(); }
+		std::unique_ptr<Tablebase> table = Tablebase::open(fileOf(m));
+		if (table == NULL) { return NULL; } // Missing tables are looked for again, they may be generated later
+		if (table->material.count != m.count || memcmp(table->material.pieces, m.pieces, m.count) != 0) { return NULL; }
+		return (tables[name] = std::move(table)).get();
+	}
+
+	// Get the value of a position from its pieces and their squares, in any order
+	byte probeValue(const byte* pieces, const byte* squares, int n, int team)
+	{
+		TbMaterial m = TbMaterial{ n, { } };
+		byte sq[TB_MAX_PIECES] = { };
+		memcpy(m.pieces, pieces, n);
+		memcpy(sq, squares, n);
+		TbMaterial::sort(m.pieces, sq, n);
+		const Tablebase* table = find(m);
+		return table != NULL ? table->value(table->index(sq, team)) : TB_INVALID;
+	}
+
+	// Find the result of a position for the team to move. Returns false if there is no table
+	// for it, or if it has castling rights or an en passant capture (critical pieces which
+	// haven't moved, or a piece with the temporary special flag).
+	bool probe(const Position& pos, TbResult& out)
+	{
+		const BoardState& board = pos.board;
+		if (popCount(board.occupied) > TB_MAX_PIECES) { return false; }
+		byte pieces[TB_MAX_PIECES], squares[TB_MAX_PIECES];
+		int n = 0;
+		UINT64 occ = board.occupied;
+		while (occ)
+		{
+			int sqr = popLsb(occ);
+			byte p = board[sqr];
+			if ((p & PIECE_SPTEMP) || (pos.pieceDefs[p & PIECE_ID]->critical && !(p & PIECE_MOVED))) { return false; }
+			pieces[n] = p & (PIECE_ID | PIECE_TEAM);
+			squares[n++] = (byte)sqr;
+		}
+		return TbResult::fromValue(probeValue(pieces, squares, n, pos.currTeam), out);
+	}
+};
+
+// Get the global tables, probed by the game after each move
+inline Tablebases& tablebases()
+{
+	static Tablebases tables;
+	return tables;
+}
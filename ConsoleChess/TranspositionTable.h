@@ -0,0 +1,242 @@
+#pragma once
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include "Platform.h"
+
+#ifdef _MSC_VER
+#include <xmmintrin.h>
+#elif !defined(_WIN32)
+#include <sys/mman.h>
+#endif
+
+// Data stored for a position in the transposition table.
+// The meaning of value is up to the user (a search score and move, a perft count...),
+// only its low 48 bits are kept.
+struct TTData
+{
+	UINT64 value;	// Payload, 48 bits
+	int depth;		// Depth the data was computed at (0-255)
+	int bound;		// Kind of value, user defined (0-3)
+
+	// Pack into the 64 bit word stored in an entry, with the table age
+	UINT64 pack(int age) const
+	{
+		return value << 16 | (UINT64)(bound & 3) << 14 | (UINT64)(age & 63) << 8 | (depth & 0xFF);
+	}
+
+	// Unpack from an entry word
+	static TTData unpack(UINT64 data)
+	{
+		return TTData{ data >> 16, (int)(data & 0xFF), (int)(data >> 14 & 3) };
+	}
+};
+
+// Hash table of position data keyed by Zobrist keys, shared between threads without locks.
+// Each entry is a (key ^ data, data) pair of words, so an entry torn by two threads writing
+// at the same time fails the key check on probe instead of returning wrong data.
+// Entries are grouped in buckets of one cache line. A new entry replaces the entry of the
+// same position, or else the entry of the bucket with the lowest depth, older searches
+// counting as lower.
+class TranspositionTable
+{
+private:
+	// Key and data of a position
+	struct Entry
+	{
+		std::atomic<UINT64> keyXor;	// Key XOR data
+		std::atomic<UINT64> data;	// Packed TTData
+	};
+
+	static const int BucketSize = 4; // Entries per bucket, 4 * 16 bytes = 64 byte cache line
+
+	// Group of entries sharing a cache line
+	struct alignas(64) Bucket
+	{
+		Entry entries[BucketSize];
+	};
+
+	Bucket* buckets;	// Table memory
+	UINT64 mask;		// Amount of buckets - 1 (a power of 2)
+	bool largePages;	// True if the memory was allocated with large pages
+	int age;			// Age of the current search, 6 bits
+
+	// Get the bucket of a key
+	Bucket& bucket(UINT64 key) const
+	{
+		return buckets[key & mask];
+	}
+
+	// Free the table memory
+	void release()
+	{
+		if (buckets == NULL) { return; }
+#ifdef _WIN32
+		if (largePages) { VirtualFree(buckets, 0, MEM_RELEASE); }
+		else { _aligned_free(buckets); }
+#else
+		free(buckets);
+#endif
+		buckets = NULL;
+	}
+
+	// Allocate bytes of table memory aligned on a cache line, using large pages if asked.
+	// Falls back to normal pages if the system does not give large pages.
+	void* allocate(size_t bytes, bool useLargePages)
+	{
+		largePages = false;
+#ifdef _WIN32
+		if (useLargePages)
+		{	// Needs the "Lock pages in memory" privilege
+			size_t page = GetLargePageMinimum();
+			if (page != 0)
+			{
+				void* mem = VirtualAlloc(NULL, (bytes + page - 1) / page * page,
+					MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+				if (mem != NULL)
+				{
+					largePages = true;
+					return mem;
+				}
+			}
+		}
+		return _aligned_malloc(bytes, 64);
+#else
+		// Transparent huge pages need 2MB alignment
+		size_t align = useLargePages ? (2 << 20) : 64;
+		void* mem = aligned_alloc(align, (bytes + align - 1) / align * align);
+#ifdef MADV_HUGEPAGE
+		if (mem != NULL && useLargePages) { largePages = madvise(mem, bytes, MADV_HUGEPAGE) == 0; }
+#endif
+		return mem;
+#endif
+	}
+
+public:
+	// Create table of a size in MB (see resize)
+	TranspositionTable(size_t mb = 16, bool useLargePages = false) : buckets(NULL), mask(0), largePages(false), age(0)
+	{
+		resize(mb, useLargePages);
+	}
+
+	~TranspositionTable()
+	{
+		release();
+	}
+
+	TranspositionTable(const TranspositionTable&) = delete;
+	TranspositionTable& operator=(const TranspositionTable&) = delete;
+
+	// Reallocate the table with at most the given size in MB. The amount of buckets is
+	// rounded down to a power of 2. Clears the table. Not thread safe.
+	void resize(size_t mb, bool useLargePages = false)
+	{
+		release();
+		size_t count = 1;
+		while (count * 2 * sizeof(Bucket) <= (mb << 20)) { count *= 2; }
+		buckets = (Bucket*)allocate(count * sizeof(Bucket), useLargePages);
+		if (buckets == NULL) { throw std::bad_alloc(); }
+		mask = count - 1;
+		clear();
+	}
+
+	// Remove all entries. Not thread safe.
+	void clear()
+	{
+		for (UINT64 i = 0; i <= mask; i++)
+		{
+			for (int j = 0; j < BucketSize; j++)
+			{
+				buckets[i].entries[j].keyXor.store(0, std::memory_order_relaxed);
+				buckets[i].entries[j].data.store(0, std::memory_order_relaxed);
+			}
+		}
+		age = 0;
+	}
+
+	// Start a new search. Entries of previous searches are replaced first.
+	void newSearch()
+	{
+		age = (age + 1) & 63;
+	}
+
+	// Load the bucket of a key into the cache ahead of a probe
+	void prefetch(UINT64 key) const
+	{
+#ifdef _MSC_VER
+		_mm_prefetch((const char*)&bucket(key), _MM_HINT_T0);
+#else
+		__builtin_prefetch(&bucket(key));
+#endif
+	}
+
+	// Find the data of a position. Returns false if it is not in the table.
+	bool probe(UINT64 key, TTData& out) const
+	{
+		const Bucket& b = bucket(key);
+		for (int i = 0; i < BucketSize; i++)
+		{
+			UINT64 data = b.entries[i].data.load(std::memory_order_relaxed);
+			UINT64 keyXor = b.entries[i].keyXor.load(std::memory_order_relaxed);
+			if ((keyXor ^ data) == key && data != 0)
+			{
+				out = TTData::unpack(data);
+				return true;
+			}
+		}
+		return false;
+	}
+
+	// Store the data of a position
+	void store(UINT64 key, const TTData& in)
+	{
+		Bucket& b = bucket(key);
+		Entry* victim = NULL;
+		int victimScore = 0x7FFFFFFF;
+		for (int i = 0; i < BucketSize; i++)
+		{
+			Entry& e = b.entries[i];
+			UINT64 data = e.data.load(std::memory_order_relaxed);
+			UINT64 keyXor = e.keyXor.load(std::memory_order_relaxed);
+			if ((keyXor ^ data) == key)
+			{	// Same position, keep deeper data of the current search
+				TTData old = TTData::unpack(data);
+				if (in.depth < old.depth && (int)(data >> 8 & 63) == age) { return; }
+				victim = &e;
+				break;
+			}
+			// Lowest depth, 8 plies less per search of age
+			int score = (int)(data & 0xFF) - 8 * ((age - (int)(data >> 8 & 63)) & 63);
+			if (score < victimScore)
+			{
+				victimScore = score;
+				victim = &e;
+			}
+		}
+		UINT64 data = in.pack(age);
+		victim->keyXor.store(key ^ data, std::memory_order_relaxed);
+		victim->data.store(data, std::memory_order_relaxed);
+	}
+
+	// Permille of the first 1000 buckets' entries used by the current search
+	int hashfull() const
+	{
+		int used = 0;
+		UINT64 n = (mask + 1 < 1000) ? mask + 1 : 1000;
+		for (UINT64 i = 0; i < n; i++)
+		{
+			for (int j = 0; j < BucketSize; j++)
+			{
+				UINT64 data = buckets[i].entries[j].data.load(std::memory_order_relaxed);
+				used += data != 0 && (int)(data >> 8 & 63) == age;
+			}
+		}
+		return (int)(used * 1000 / (n * BucketSize));
+	}
+
+	// Size of the table in bytes
+	size_t size() const
+	{
+		return (size_t)(mask + 1) * sizeof(Bucket);
+	}
+};
@@ -1,99 +1,83 @@
 #pragma once
-#include <Windows.h>
+#include "Platform.h"
 #include <vector>
+#include <memory>
 #include "PieceDef.h"
+#include "UnitMoveset.h"
+#include "SlidingAttacks.h"
 #include <algorithm>
 
-// Enum defining the types of symmetry that can be applied to unit moves. 
-enum MoveSymmetry : int
-{
-	// First 2 bits determines reflection (ex. knight) - APPLIED LAST, 
-	// Thrid 45deg. rotation (ex. queen),
-	// Fourth 90deg. rotation (ex. rook)
-	None =		0b0000, 
-	Rotate90 =	0b0001,
-	Rot90_45 =  0b0010,
-	Rotate45 =	0b0011,
-	FlipX =		0b0100,
-	FlipY =		0b1000
-};
-
 // Type of PieceDef with moves generated from unit moves 
 class UnitMovePiece : public PieceDef
 {
 private:
-	// 16x16 byte array storing moveset information.
-	byte moveset[256];
+	// Moveset and bitboards of the piece, a constant or the tables in owned.
+	const UnitMoveset* tables;
+	// Tables built while the program runs, if any.
+	std::unique_ptr<UnitMoveset> owned;
+	// Occupancy indexed attack tables, built if the piece can be obstructed.
+	SlidingAttacks sliding;
+	// True if the moves of this piece can be obstructed by other pieces.
+	bool slider;
 
+	// Build the sliding attack tables if the piece can be obstructed, and derive the
+	// default evaluation from the mobility on an empty board.
+	void initTables(const SlidingMagic* magics = NULL, int magicCount = 0)
+	{
+		canJump = tables->canJump;
+		slider = tables->slider;
+		if (slider) { sliding.build(tables->reach, tables->shadows, tables->firstStep, magics, magicCount); }
+		int mobility[64];
+		for (int i = 0; i < 64; i++) { mobility[i] = popCount(tables->reach[i]); }
+		deriveEvaluation(mobility);
+	}
 
 public:
 	// If true, this piece can jump over other pieces.
 	bool canJump;
 
 	// Ctor
-	UnitMovePiece(byte id, bool critical, bool canJump, Byte88 sprite) : moveset{ }
+	UnitMovePiece(byte id, bool critical, bool canJump, const Byte88& sprite) : tables(NULL), slider(false)
 	{
 		this->id = id;
 		this->critical = critical;
 		this->canJump = canJump;
 		this->sprite = Byte88(sprite);
+		// Moves only depend on the moveset, never on the flags
+		this->hashedFlags = 0;
+	}
+
+	// Initialize moveset data based on given unit moves with symmetry, etc. The tables are
+	// built while the program runs, see setMoveset for pieces known when compiling.
+	void generateMoveset(const std::vector<IVec2>& unitMoves, int sym, bool repeat)
+	{
+		owned.reset(new UnitMoveset(makeUnitMoveset(unitMoves.data(), (int)unitMoves.size(), sym, repeat, canJump)));
+		tables = owned.get();
+		initTables();
 	}
 
-	// Initialize moveset data based on given unit moves with symmetry, etc.
-	void generateMoveset(std::vector<IVec2> unitMoves, int sym, bool repeat)
+	// Use a moveset built by makeUnitMoveset, usually a constant. It must outlive the piece.
+	void setMoveset(const UnitMoveset& moveset)
 	{
-		// First fill apply symmetries on the unit moves.
-		if (sym & Rotate90) // 90 deg. rotate
-		{
-			int csz = unitMoves.size();
-			for (int i = 0; i < csz; i++) 
-			{
-				IVec2 mv = unitMoves[i]; // Orig. move
-				IVec2 dv = IVec2(mv.x - mv.y, mv.x + mv.y); // 45deg. rotated move
-				// Rotate orig. by 90deg. on other axes
-				unitMoves.push_back(IVec2(-mv.y, mv.x));
-				unitMoves.push_back(IVec2(mv.y, -mv.x));
-				unitMoves.push_back(IVec2(-mv.x, -mv.y));
-				// 45 deg rotate
-				if (sym & Rot90_45) 
-				{	// Add 90deg. rotations of the 45deg. rotation
-					unitMoves.push_back(dv);
-					unitMoves.push_back(IVec2(-dv.y, dv.x));
-					unitMoves.push_back(IVec2(dv.y, -dv.x));
-					unitMoves.push_back(IVec2(-dv.x,-dv.y));
-				}
-			}
-		}
-		if (sym & (FlipX | FlipY)) // Reflect
-		{
-			int csz = unitMoves.size();
-			for (int i = 0; i < csz; i++)
-			{
-				IVec2 mv = unitMoves[i]; // Orig. move
-				if (sym & FlipX) { unitMoves.push_back(IVec2(-mv.x, mv.y)); } // X Flip
-				if (sym & FlipY) { unitMoves.push_back(IVec2(mv.x, -mv.y)); } // Y Flip
-			}
-		}
-		// Fill moveset data from generated unit moves
-
-		// Set moveset to zero and will moveset table
-		std::fill_n(moveset, sizeof(moveset), 0);
-		for (int i = 0; i < unitMoves.size(); i++) 
-		{
-			IVec2 mv = unitMoves[i]; // Current unit move
-			IVec2 delta = mv; // Current delta
-			int j = 0x88; // moveset index for 0 delta
-
-			do 	// While move is in range of the board, repeat it
-			{
-				// Calculate current moveset index and set to previous
-				int jc = (delta.y + 8) << 4 | (delta.x + 8);
-				moveset[jc] = j;
-				// Update moveset index and increment delta
-				j = jc;
-				delta += mv;
-			} while (repeat && abs(delta.x) < 8 && abs(delta.y) < 8);
-		}
+		owned.reset();
+		tables = &moveset;
+		initTables();
+	}
+
+	// Use a constant moveset with the magics of its sliding attack tables, found by an
+	// earlier build (see magics), so the tables are built without searching for them.
+	template<int N>
+	void setMoveset(const UnitMoveset& moveset, const SlidingMagic (&magics)[N])
+	{
+		owned.reset();
+		tables = &moveset;
+		initTables(magics, N);
+	}
+
+	// Get the magics of the sliding attack tables, to pass to setMoveset
+	std::vector<SlidingMagic> magics() const
+	{
+		return sliding.magics();
 	}
 
 	// Check if potential move is pseudolegal
@@ -101,28 +85,61 @@ public:
 	{
 		// Check for team of piece at the end 
 		if (board[end] != 0 && board.getPiece(end).team == board.getPiece(start).team) { return false; }
-		// Find displacement of piece
-		IVec2 delta = end - start;
-		// Get index in moveset array
-		int i = (delta.y + 8) << 4 | (delta.x + 8);
-		// Location not in moveset or onto our piece
-		if (moveset[i] == 0) { return false; }
-		// Location in moveset and can jump over pieces
-		else if (canJump) { return true; }
-		// Check for possible obstruction
-		else
-		{
-			// Jump to previous positions on the move path until the 0 delta
-			while (moveset[i] != 0x88)
-			{
-				i = moveset[i]; // Get previous position in move path
-				IVec2 d = IVec2((i & 0xF) - 8, (i >> 4) - 8); // Calculate equiv. delta
-				// Check if piece lies in the intermediate square
-				if (board[start + d] != 0) { return false; }
-			}
-			// Path was not blocked by another piece, move is valid
-			return true;
-		}
+		// Location must be in the moveset, with nothing on the path to it
+		int from = POS_TO_INDEX(start), to = POS_TO_INDEX(end);
+		if ((tables->reach[from] & SQUARE_BB(to)) == 0) { return false; }
+		return (tables->between[64 * from + to] & board.occupied) == 0;
+	}
+
+	// Get the bitboard of pseudolegal targets
+	UINT64 targets(IVec2 start, const BoardState &board) override
+	{
+		int from = POS_TO_INDEX(start);
+		// Sliders look up their attack set from the occupancy, others can't be obstructed
+		UINT64 tgts = slider ? sliding.attacks(from, board.occupied) : tables->reach[from];
+		// Can't move onto our own pieces
+		return tgts & ~board.teamBB[board.getPiece(from).team];
+	}
+
+	// Get the squares which must be empty to attack end from start
+	bool attackPath(IVec2 start, IVec2 end, const BoardState &board, UINT64 &path) override
+	{
+		if (!end.in88Square()) { return false; }
+		int from = POS_TO_INDEX(start), to = POS_TO_INDEX(end);
+		if ((tables->reach[from] & SQUARE_BB(to)) == 0) { return false; }
+		path = tables->between[64 * from + to];
+		return true;
+	}
+
+	// Get the moveset and bitboards of the piece
+	const UnitMoveset& getMoveset() const
+	{
+		return *tables;
+	}
+
+	// Moves only depend on the moveset paths
+	bool hasAttackPaths() override
+	{
+		return true;
+	}
+
+	// Get the bitboard of attacked squares
+	UINT64 attacks(IVec2 start, const BoardState &board) override
+	{
+		int from = POS_TO_INDEX(start);
+		return slider ? sliding.attacks(from, board.occupied) : tables->reach[from];
+	}
+
+	// Append the pseudolegal moves to a move list, captures first
+	void generateMoves(IVec2 start, const BoardState &board, MoveList &moves) override
+	{
+		int from = POS_TO_INDEX(start);
+		int team = board.getPiece(from).team;
+		UINT64 tgts = slider ? sliding.attacks(from, board.occupied) : tables->reach[from];
+		UINT64 caps = tgts & board.teamBB[team ^ 1];
+		UINT64 quiets = tgts & ~board.occupied;
+		while (caps) { moves.add(from, popLsb(caps), MoveCapture); }
+		while (quiets) { moves.add(from, popLsb(quiets), MoveQuiet); }
 	}
 };
 
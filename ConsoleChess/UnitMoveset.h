@@ -0,0 +1,150 @@
+#pragma once
+#include "Platform.h"
+#include "IVec2.h"
+#include "Bitboard.h"
+
+#define UNIT_MOVES_MAX 224 // Most distinct unit moves which can land on the board, every delta of -7 to 7 but 0
+
+// Enum defining the types of symmetry that can be applied to unit moves.
+enum MoveSymmetry : int
+{
+	// First 2 bits determines reflection (ex. knight) - APPLIED LAST,
+	// Thrid 45deg. rotation (ex. queen),
+	// Fourth 90deg. rotation (ex. rook)
+	None =		0b0000,
+	Rotate90 =	0b0001,
+	Rot90_45 =  0b0010,
+	Rotate45 =	0b0011,
+	FlipX =		0b0100,
+	FlipY =		0b1000
+};
+
+// Moveset of a UnitMovePiece and the bitboards derived from it. makeUnitMoveset is
+// constexpr, so the tables of pieces known when compiling (see StandardPieces) are
+// constants of the program, and pieces created while it runs use the same code.
+struct UnitMoveset
+{
+	// 16x16 table indexed by move delta ((dy + 8) << 4 | (dx + 8)). Non zero entries are
+	// moves, holding the index of the previous square on their path (0x88 for the start).
+	byte moveset[256];
+	// Bitboard of the squares reachable from each square on an empty board.
+	UINT64 reach[64];
+	// shadows[64*from + sqr] holds the squares hidden from a piece at "from" when
+	// "sqr" is occupied. Empty for pieces that can jump.
+	UINT64 shadows[64 * 64];
+	// between[64*from + sqr] holds the squares on the path from "from" to a square it
+	// reaches, which must be empty for the move. Empty for pieces that can jump. These
+	// are the board rays (see RayTables) for riders moving along lines.
+	UINT64 between[64 * 64];
+	// firstStep[64*from + sqr] is the first square on the path from "from" to "sqr",
+	// used to group the squares by direction (see SlidingAttacks).
+	byte firstStep[64 * 64];
+	// True if the piece can jump over other pieces.
+	bool canJump;
+	// True if the moves of the piece can be obstructed by other pieces.
+	bool slider;
+};
+
+// Add a unit move to the list of a moveset being built, unless it is already in it. Moves
+// of 8 squares or more never land on the board, nor do their rotations and reflections,
+// so they are left out and the list never holds more than UNIT_MOVES_MAX moves.
+constexpr void addUnitMove(int* mx, int* my, int& n, bool* seen, int x, int y)
+{
+	if (x < -7 || x > 7 || y < -7 || y > 7 || (x == 0 && y == 0)) { return; }
+	int j = (y + 8) << 4 | (x + 8);
+	if (seen[j]) { return; }
+	seen[j] = true;
+	mx[n] = x;
+	my[n++] = y;
+}
+
+// Build the moveset of unit moves with symmetries applied, repeated until the edge of the
+// board if repeat is true, and its bitboards.
+constexpr UnitMoveset makeUnitMoveset(const IVec2* unitMoves, int count, int sym, bool repeat, bool canJump)
+{
+	// First apply the symmetries on the unit moves
+	int mx[UNIT_MOVES_MAX] = { }, my[UNIT_MOVES_MAX] = { };
+	bool seen[256] = { };
+	int n = 0;
+	for (int i = 0; i < count; i++) { addUnitMove(mx, my, n, seen, unitMoves[i].x, unitMoves[i].y); }
+	if (sym & Rotate90) // 90 deg. rotate
+	{
+		int csz = n;
+		for (int i = 0; i < csz; i++)
+		{
+			int x = mx[i], y = my[i];
+			int dx = x - y, dy = x + y; // 45deg. rotated move
+			// Rotate orig. by 90deg. on other axes
+			addUnitMove(mx, my, n, seen, -y, x);
+			addUnitMove(mx, my, n, seen, y, -x);
+			addUnitMove(mx, my, n, seen, -x, -y);
+			if (sym & Rot90_45)
+			{	// Add 90deg. rotations of the 45deg. rotation
+				addUnitMove(mx, my, n, seen, dx, dy);
+				addUnitMove(mx, my, n, seen, -dy, dx);
+				addUnitMove(mx, my, n, seen, dy, -dx);
+				addUnitMove(mx, my, n, seen, -dx, -dy);
+			}
+		}
+	}
+	if (sym & (FlipX | FlipY)) // Reflect
+	{
+		int csz = n;
+		for (int i = 0; i < csz; i++)
+		{
+			int x = mx[i], y = my[i];
+			if (sym & FlipX) { addUnitMove(mx, my, n, seen, -x, y); } // X Flip
+			if (sym & FlipY) { addUnitMove(mx, my, n, seen, x, -y); } // Y Flip
+		}
+	}
+
+	UnitMoveset m = { };
+	m.canJump = canJump;
+	// Fill the moveset table from the unit moves
+	for (int i = 0; i < n; i++)
+	{
+		int dx = mx[i], dy = my[i];
+		int j = 0x88; // moveset index for 0 delta
+		do 	// While move is in range of the board, repeat it
+		{
+			int jc = (dy + 8) << 4 | (dx + 8);
+			m.moveset[jc] = (byte)j;
+			j = jc;
+			dx += mx[i];
+			dy += my[i];
+		} while (repeat && dx < 8 && dx > -8 && dy < 8 && dy > -8);
+	}
+
+	// Bitboards of every start square, walking the path of each move back to the start
+	int moves[256] = { };
+	int nMoves = 0;
+	for (int i = 0; i < 256; i++)
+	{
+		if (m.moveset[i] != 0) { moves[nMoves++] = i; }
+	}
+	for (int from = 0; from < 64; from++)
+	{
+		int fx = from & 7, fy = from >> 3;
+		for (int k = 0; k < nMoves; k++)
+		{
+			int i = moves[k];
+			int ex = fx + (i & 0xF) - 8, ey = fy + (i >> 4) - 8;
+			if (ex < 0 || ex > 7 || ey < 0 || ey > 7) { continue; }
+			int end = ey << 3 | ex;
+			m.reach[from] |= SQUARE_BB(end);
+			if (canJump) { continue; }
+			// Every square on the move path hides the end square when occupied
+			int j = i, sqr = end;
+			while (m.moveset[j] != 0x88)
+			{
+				j = m.moveset[j];
+				sqr = (fy + (j >> 4) - 8) << 3 | (fx + (j & 0xF) - 8);
+				m.shadows[64 * from + sqr] |= SQUARE_BB(end);
+				m.between[64 * from + end] |= SQUARE_BB(sqr);
+				m.slider = true;
+			}
+			m.firstStep[64 * from + end] = (byte)sqr;
+		}
+	}
+	return m;
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include "Platform.h"
+
+// Define VERIFY_HASH to check the incremental Zobrist key against a full
+// recomputation after every move. Enabled by default in debug builds.
+#if defined(_DEBUG) && !defined(VERIFY_HASH)
+#define VERIFY_HASH
+#endif
+
+// Random keys of the Zobrist hash of a board.
+// The key of a piece is piece[sqr][team|id], XORed with flags[sqr][f] where f is made of
+// the flag bits (moved, special temp, special perm) of the piece which affect its moves.
+// Flags which do not matter to a piece (ex. the moved flag of a rook) are left out of the
+// key, so that positions which only differ by them are the same for the caches. The flags
+// hashed for each piece ID belong to the pieces of the board (see PieceTables).
+struct ZobristKeys
+{
+	UINT64 piece[64][32];	// Key of each team and piece ID on each square
+	UINT64 flags[64][8];	// Key of each combination of flags (>> 5) on each square
+	UINT64 side;			// Key of white (team 1) to move
+
+	// Fill the keys with a fixed seed, so keys are the same on every run
+	ZobristKeys()
+	{
+		UINT64 seed = 0x2545F4914F6CDD1DULL;
+		auto random = [&seed]()
+		{	// xorshift64*
+			seed ^= seed >> 12;
+			seed ^= seed << 25;
+			seed ^= seed >> 27;
+			return seed * 2685821657736338717ULL;
+		};
+		for (int i = 0; i < 64; i++)
+		{
+			for (int j = 0; j < 32; j++) { piece[i][j] = (j & 0xF) ? random() : 0; }
+			for (int j = 0; j < 8; j++) { flags[i][j] = j ? random() : 0; }
+		}
+		side = random();
+	}
+
+	// Get the key of a board byte on a square (0 for empty squares), with the flags hashed
+	// for each piece ID. The low 5 bits of the byte are the team and ID, and the high 3
+	// bits the flags.
+	UINT64 key(int sqr, byte b, const byte* hashedFlags) const
+	{
+		return piece[sqr][b & 0x1F] ^ flags[sqr][(b & hashedFlags[b & 0xF]) >> 5];
+	}
+};
+
+// Get the global Zobrist keys
+inline ZobristKeys& zobrist()
+{
+	static ZobristKeys keys;
+	return keys;
+}
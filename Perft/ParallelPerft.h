@@ -0,0 +1,156 @@
+#pragma once
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Perft.h"
+
+// Perft split across a pool of threads.
+// The move tree is cut into tasks at the root and at every level down to a split
+// depth below it. Each worker owns a deque of tasks: it expands and counts its
+// newest task first, and when its deque is empty it steals the oldest (largest)
+// task of another worker. Tasks carry their own Position, so workers never share
+// a board or its undo state. Counts are summed per root move, so the results do
+// not depend on the scheduling and match the single threaded perft.
+class ParallelPerft
+{
+private:
+	// A position to count, below a root move
+	struct Task
+	{
+		Position pos;	// Position to count, owned by the task
+		int depth;		// Remaining depth
+		int split;		// Remaining levels to split into more tasks
+		int root;		// Index of the root move the task is below
+	};
+
+	// Task deque of a thread
+	struct Worker
+	{
+		std::deque<Task> tasks;
+		std::mutex lock;
+	};
+
+	std::vector<std::unique_ptr<Worker>> workers;	// Deques of every thread
+	std::unique_ptr<std::atomic<UINT64>[]> counts;	// Leaf nodes below each root move
+	std::atomic<long long> pending;					// Tasks queued or being processed
+
+	// Add a task to the deque of a thread
+	void push(int thread, Task&& task)
+	{
+		pending++;
+		std::lock_guard<std::mutex> guard(workers[thread]->lock);
+		workers[thread]->tasks.push_back(std::move(task));
+	}
+
+	// Take the newest task of a thread, or steal the oldest task of another one
+	bool pop(int thread, Task& task)
+	{
+		int n = (int)workers.size();
+		for (int i = 0; i < n; i++)
+		{
+			Worker& w = *workers[(thread + i) % n];
+			std::lock_guard<std::mutex> guard(w.lock);
+			if (w.tasks.empty()) { continue; }
+			if (i == 0)
+			{
+				task = std::move(w.tasks.back());
+				w.tasks.pop_back();
+			}
+			else
+			{
+				task = std::move(w.tasks.front());
+				w.tasks.pop_front();
+			}
+			return true;
+		}
+		return false;
+	}
+
+	// Split a task into tasks for its children, or count it
+	void process(int thread, Task& task)
+	{
+		if (task.split <= 0 || task.depth <= 2)
+		{
+			counts[task.root] += perft(task.pos, task.depth, tt);
+			return;
+		}
+		MoveList moves;
+		task.pos.generateLegalMoves(task.pos.currTeam, moves);
+		for (int i = 0; i < moves.size; i++)
+		{
+			forEachChild(task.pos, moves[i], [&](Position& child)
+			{
+				push(thread, Task{ child, task.depth - 1, task.split - 1, task.root });
+			});
+		}
+	}
+
+	// Main loop of a worker thread, runs until every task is done
+	void work(int thread)
+	{
+		Task task = Task{ Position(std::vector<PieceDef*>()), 0, 0, 0 };
+		while (pending > 0)
+		{
+			if (!pop(thread, task))
+			{
+				std::this_thread::yield();
+				continue;
+			}
+			process(thread, task);
+			pending--;
+		}
+	}
+
+public:
+	int threads;			// Amount of worker threads
+	int splitDepth;			// Levels below the root moves which are split into tasks
+	TranspositionTable* tt;	// Table of subtree counts shared by the threads, or NULL
+
+	ParallelPerft(int threads, int splitDepth, TranspositionTable* tt = NULL) :
+		threads(threads > 0 ? threads : 1), splitDepth(splitDepth), tt(tt) {};
+
+	// Count the leaf nodes below each root move of a position. Writes the count of
+	// moves[i] to moveNodes[i] if not NULL, and returns the total.
+	UINT64 run(Position& root, int depth, const MoveList& moves, UINT64* moveNodes = NULL)
+	{
+		counts.reset(new std::atomic<UINT64>[moves.size > 0 ? moves.size : 1]);
+		for (int i = 0; i < moves.size; i++) { counts[i] = 0; }
+		workers.clear();
+		for (int i = 0; i < threads; i++) { workers.push_back(std::unique_ptr<Worker>(new Worker())); }
+		pending = 0;
+		// Root moves are dealt to the workers in turn, shallow trees are counted directly
+		for (int i = 0; i < moves.size; i++)
+		{
+			if (depth <= 2) { counts[i] = perftMove(root, moves[i], depth, tt); continue; }
+			forEachChild(root, moves[i], [&](Position& child)
+			{
+				push(i % threads, Task{ child, depth - 1, splitDepth, i });
+			});
+		}
+		std::vector<std::thread> pool;
+		for (int i = 1; i < threads; i++) { pool.push_back(std::thread(&ParallelPerft::work, this, i)); }
+		work(0);
+		for (auto& t : pool) { t.join(); }
+
+		UINT64 total = 0;
+		for (int i = 0; i < moves.size; i++)
+		{
+			if (moveNodes != NULL) { moveNodes[i] = counts[i]; }
+			total += counts[i];
+		}
+		return total;
+	}
+
+	// Count the leaf nodes of the legal move tree to a depth
+	UINT64 run(Position& root, int depth)
+	{
+		if (depth <= 0) { return 1; }
+		MoveList moves;
+		root.generateLegalMoves(root.currTeam, moves);
+		return run(root, depth, moves);
+	}
+};
@@ -0,0 +1,181 @@
+// Perft.cpp : Headless move generator test. Counts the leaf nodes of the legal
+// move tree (perft) for the standard piece set, without creating a GameWindow.
+//
+// Usage:
+//   perft [depth] [-fen "<fen>"] [-divide] [options]
+//   perft -suite <file.epd> [-maxdepth <n>] [options]
+// Options: -threads <n> -split <n> -hash <MB> -largepages -dynamic
+//
+
+#define _CRT_SECURE_NO_WARNINGS // sscanf
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+
+#include "Position.h"
+#include "StandardPieces.h"
+#include "Fen.h"
+#include "Perft.h"
+#include "ParallelPerft.h"
+
+// Print the node count below each root move, and return the total
+UINT64 divide(ParallelPerft& pp, Position& pos, int depth)
+{
+	MoveList moves;
+	pos.generateLegalMoves(pos.currTeam, moves);
+	UINT64 moveNodes[MAX_MOVES];
+	UINT64 total = pp.run(pos, depth, moves, moveNodes);
+	for (int i = 0; i < moves.size; i++)
+	{
+		printf("%s%s: %llu\n", squareName(moves[i].from()).c_str(), squareName(moves[i].to()).c_str(), moveNodes[i]);
+	}
+	return total;
+}
+
+// Seconds since an arbitrary point
+double now()
+{
+	using namespace std::chrono;
+	return duration<double>(steady_clock::now().time_since_epoch()).count();
+}
+
+// Print a node count with its timing
+void report(int depth, UINT64 nodes, double time)
+{
+	double nps = (time > 0) ? nodes / time : 0;
+	printf("depth %d: %llu nodes  %.3fs  %.0f nodes/s\n", depth, nodes, time, nps);
+}
+
+// Run the positions of an EPD file ("<fen> ;D1 <count> ;D2 <count> ...") with a PieceSetKind and compare
+// the counts. Returns the amount of mismatched counts, or -1 if the file can't be read.
+int runSuite(ParallelPerft& pp, std::vector<PieceDef*> pieces, int pieceSet, const char* path, int maxDepth)
+{
+	std::ifstream file(path);
+	if (!file) { return -1; }
+	int failed = 0;
+	UINT64 totalNodes = 0;
+	double totalTime = 0;
+	std::string line;
+	while (std::getline(file, line))
+	{
+		if (line.empty() || line[0] == '#') { continue; }
+		size_t sep = line.find(';');
+		std::string fen = line.substr(0, sep);
+		BoardState board;
+		byte team;
+		if (!loadFen(fen, board, team))
+		{
+			printf("bad FEN: %s\n", fen.c_str());
+			failed++;
+			continue;
+		}
+		printf("%s\n", fen.c_str());
+		Position pos = Position(pieces, board, team);
+		pos.usePieceSet(pieceSet);
+		while (sep != std::string::npos)
+		{
+			int depth;
+			unsigned long long expected;
+			if (sscanf(line.c_str() + sep + 1, " D%d %llu", &depth, &expected) == 2 && depth <= maxDepth)
+			{
+				double t = now();
+				UINT64 nodes = pp.run(pos, depth);
+				t = now() - t;
+				report(depth, nodes, t);
+				totalNodes += nodes;
+				totalTime += t;
+				if (nodes != expected)
+				{
+					printf("  FAILED, expected %llu\n", expected);
+					failed++;
+				}
+			}
+			sep = line.find(';', sep + 1);
+		}
+	}
+	printf("total: %llu nodes  %.3fs  %.0f nodes/s\n", totalNodes, totalTime, totalTime > 0 ? totalNodes / totalTime : 0);
+	printf(failed ? "%d count(s) FAILED\n" : "all counts match\n", failed);
+	return failed;
+}
+
+int main(int argc, char** argv)
+{
+	StandardPieces pieces;
+	int depth = 5, maxDepth = 64;
+	int threads = (int)std::thread::hardware_concurrency(), split = 2;
+	int hashMB = 0;
+	bool largePages = false;
+	bool doDivide = false;
+	int pieceSet = PieceSetStandard; // -dynamic tests the PieceDef virtual functions instead
+	const char* fen = NULL;
+	const char* suite = NULL;
+	for (int i = 1; i < argc; i++)
+	{
+		if (!strcmp(argv[i], "-fen") && i + 1 < argc) { fen = argv[++i]; }
+		else if (!strcmp(argv[i], "-divide")) { doDivide = true; }
+		else if (!strcmp(argv[i], "-suite") && i + 1 < argc) { suite = argv[++i]; }
+		else if (!strcmp(argv[i], "-maxdepth") && i + 1 < argc) { maxDepth = atoi(argv[++i]); }
+		else if (!strcmp(argv[i], "-threads") && i + 1 < argc) { threads = atoi(argv[++i]); }
+		else if (!strcmp(argv[i], "-split") && i + 1 < argc) { split = atoi(argv[++i]); }
+		else if (!strcmp(argv[i], "-hash") && i + 1 < argc) { hashMB = atoi(argv[++i]); }
+		else if (!strcmp(argv[i], "-largepages")) { largePages = true; }
+		else if (!strcmp(argv[i], "-dynamic")) { pieceSet = PieceSetDynamic; }
+		else if (isdigit(argv[i][0])) { depth = atoi(argv[i]); }
+		else
+		{
+			printf("usage: perft [depth] [-fen \"<fen>\"] [-divide] [options]\n");
+			printf("       perft -suite <file.epd> [-maxdepth <n>] [options]\n");
+			printf("options: -threads <n> -split <n> -hash <MB> -largepages -dynamic\n");
+			return 2;
+		}
+	}
+
+	// Optional table of subtree counts, shared by the threads
+	std::unique_ptr<TranspositionTable> tt;
+	if (hashMB > 0) { tt.reset(new TranspositionTable(hashMB, largePages)); }
+	// Threads count subtrees split down to the given depth below the root moves
+	ParallelPerft pp(threads, split, tt.get());
+	printf("%d thread(s), split depth %d", pp.threads, pp.splitDepth);
+	if (tt) { printf(", %zu MB hash", tt->size() >> 20); }
+	printf("\n");
+
+	if (suite != NULL)
+	{
+		int failed = runSuite(pp, pieces.list(), pieceSet, suite, maxDepth);
+		if (failed < 0) { printf("can't read %s\n", suite); }
+		return failed != 0;
+	}
+
+	Position pos = Position(pieces.list(), StandardPieces::startingBoard(), 1);
+	pos.usePieceSet(pieceSet);
+	if (fen != NULL)
+	{
+		BoardState board;
+		byte team;
+		if (!loadFen(fen, board, team))
+		{
+			printf("bad FEN: %s\n", fen);
+			return 2;
+		}
+		pos.setBoard(board, team);
+	}
+
+	if (doDivide)
+	{
+		double t = now();
+		UINT64 nodes = divide(pp, pos, depth);
+		report(depth, nodes, now() - t);
+		return 0;
+	}
+	for (int d = 1; d <= depth; d++)
+	{
+		double t = now();
+		UINT64 nodes = pp.run(pos, d);
+		report(d, nodes, now() - t);
+	}
+	return 0;
+}
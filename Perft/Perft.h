@@ -0,0 +1,80 @@
+#pragma once
+#include "Position.h"
+#include "TranspositionTable.h"
+
+// Amount of pieces the piece at a position can promote to
+inline int promotionCount(Position& pos, IVec2 sqr)
+{
+	int cnt = 0;
+	for (int id = 0; id < 16; id++) { cnt += pos.canPromote(sqr, id); }
+	return cnt;
+}
+
+// Call f with every position reached by a move, made on the position and undone after.
+// Moves which promote reach one position per piece they can promote to.
+template<typename F>
+void forEachChild(Position& pos, const Move& move, F f)
+{
+	if (!pos.makeMove(move.start(), move.end()))
+	{
+		f(pos);
+		pos.undoMove();
+		return;
+	}
+	for (int id = 0; id < 16; id++)
+	{
+		if (!pos.canPromote(move.end(), id)) { continue; }
+		pos.promote(move.end(), id);
+		f(pos);
+		// Make the move again for the next piece to promote to
+		pos.undoMove();
+		pos.makeMove(move.start(), move.end());
+	}
+	pos.undoMove();
+}
+
+// Key of a perft count in the transposition table, each depth is a different entry
+inline UINT64 perftKey(UINT64 key, int depth)
+{
+	return key ^ (UINT64)depth * 0x9E3779B97F4A7C15ULL;
+}
+
+// Count the leaf nodes of the legal move tree to a depth. If a transposition table
+// is given, the counts of subtrees are stored in it and reused on transpositions.
+inline UINT64 perft(Position& pos, int depth, TranspositionTable* tt = NULL)
+{
+	if (depth == 0) { return 1; }
+	MoveList moves;
+	TTData entry;
+	if (depth > 1 && tt != NULL && tt->probe(perftKey(pos.hashKey(), depth), entry) && entry.depth == depth)
+	{
+		return entry.value;
+	}
+	pos.generateLegalMoves(pos.currTeam, moves);
+	UINT64 nodes = 0;
+	if (depth == 1)
+	{	// Bulk counting, the leaves don't need to be made
+		for (int i = 0; i < moves.size; i++)
+		{
+			nodes += (moves[i].flags() & MovePromotion) ? promotionCount(pos, moves[i].start()) : 1;
+		}
+		return nodes;
+	}
+	for (int i = 0; i < moves.size; i++)
+	{
+		if (tt != NULL && depth > 2) { tt->prefetch(perftKey(pos.keyAfter(moves[i]), depth - 1)); }
+		forEachChild(pos, moves[i], [&](Position& child) { nodes += perft(child, depth - 1, tt); });
+	}
+	// Counts which don't fit in an entry are not stored
+	if (tt != NULL && nodes < (1ULL << 48)) { tt->store(perftKey(pos.hashKey(), depth), TTData{ nodes, depth, 0 }); }
+	return nodes;
+}
+
+// Count the leaf nodes below a move. Promotions count once per promoted piece.
+inline UINT64 perftMove(Position& pos, const Move& move, int depth, TranspositionTable* tt = NULL)
+{
+	if (depth <= 1) { return (move.flags() & MovePromotion) ? promotionCount(pos, move.start()) : 1; }
+	UINT64 nodes = 0;
+	forEachChild(pos, move, [&](Position& child) { nodes += perft(child, depth - 1, tt); });
+	return nodes;
+}
@@ -0,0 +1,614 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Tablebase.h"
+#include "MoveList.h"
+
+// Generates the tables of materials by retrograde analysis, for any pieces which describe
+// their attack paths (see PieceDef::hasAttackPaths) with one critical piece per team, and
+// irreversible pieces (pawns) on one team at most so no move can be taken en passant.
+// A first pass goes through the moves of every position once: it marks the invalid ones,
+// finds the checkmates, solves what the tables of the other materials (reached by captures
+// and promotions) tell, and counts the distinct positions of the table each one reaches.
+// The positions are then solved by increasing distance to mate, going backward from the
+// positions solved at each distance to the positions which reach them (their unmoves): a
+// position reaching a loss in d plies is won in d + 1, and a position whose moves all
+// reach wins is lost in one ply more than the longest of them, once its count drops to 0.
+// Pieces have no move undo generator: the unmoves of pieces whose quiet moves undo
+// themselves (see undoesItself) are their moves to empty squares, the other pieces (pawns)
+// are put on each empty square to find the ones they move from.
+// Mates longer than TB_MAX_DISTANCE plies don't fit in a value byte and stay draws.
+class TablebaseGen
+{
+private:
+	// Board of a position being looked at, one per thread
+	struct Scratch
+	{
+		BoardState board;
+		byte squares[TB_MAX_PIECES];
+		int count;
+		int team;
+	};
+
+	// Position solved at the distance of a round
+	typedef std::pair<UINT64, int> Solved;
+
+	PieceDef** defs;			// Piece definitions
+	Tablebases& tables;			// Tables of the other materials, and folder of the generated ones
+
+	Tablebase* table;			// Table being generated
+	std::vector<byte> values;	// Values of its positions
+	std::vector<byte> counts;	// Positions of the table each position reaches which aren't solved as wins, + 1 if another table has a draw or a win for it
+	std::vector<byte> extWins;	// Longest win + 1 another table has for the team not to move of each position, 0 if none
+	int crits[2];				// ID of the critical piece of each team
+	bool undoes[PIECE_ID + PIECE_TEAM + 1];	// undoesItself of each piece of the material
+	std::set<std::string> opened;	// Materials whose table and the tables it reaches are open
+
+	// Check if a piece can stand on a square: irreversible pieces (pawns) never stand on
+	// the first and last ranks
+	bool allowed(byte piece, int sqr) const
+	{
+		return !defs[piece & PIECE_ID]->irreversible || ((sqr >> 3) != 0 && (sqr >> 3) != 7);
+	}
+
+	// Apply a symmetry of the board to a bitboard
+	static UINT64 transform(int t, UINT64 bb)
+	{
+		UINT64 out = 0;
+		while (bb) { out |= SQUARE_BB(tbTransform(t, popLsb(bb))); }
+		return out;
+	}
+
+	// Find the symmetries of the board every piece of a material moves the same under: each
+	// piece alone on a transformed square must reach the transformed squares.
+	int symmetriesOf(const TbMaterial& m)
+	{
+		int mask = 1;
+		for (int t = 1; t < 8; t++)
+		{
+			bool same = true;
+			for (int i = 0; i < m.count && same; i++)
+			{
+				for (int sqr = 0; sqr < 64 && same; sqr++)
+				{
+					int tsqr = tbTransform(t, sqr);
+					if (!allowed(m.pieces[i], sqr)) { continue; }
+					if (!allowed(m.pieces[i], tsqr))
+					{
+						same = false;
+						break;
+					}
+					BoardState a = BoardState(), b = BoardState();
+					a.set(sqr, tbPieceByte(defs, m.pieces[i], sqr));
+					b.set(tsqr, tbPieceByte(defs, m.pieces[i], tsqr));
+					PieceDef* def = defs[m.pieces[i] & PIECE_ID];
+					IVec2 start = IVec2(sqr & 7, sqr >> 3), tstart = IVec2(tsqr & 7, tsqr >> 3);
+					same = transform(t, def->targets(start, a)) == def->targets(tstart, b) &&
+						transform(t, def->attacks(start, a)) == def->attacks(tstart, b);
+				}
+			}
+			if (same) { mask |= 1 << t; }
+		}
+		return mask;
+	}
+
+	// Check if a piece alone on the board attacks a square with no square in between
+	bool touches(byte piece, int from, int to) const
+	{
+		BoardState board = BoardState();
+		board.set(from, tbPieceByte(defs, piece, from));
+		UINT64 path;
+		return defs[piece & PIECE_ID]->attackPath(IVec2(from & 7, from >> 3), IVec2(to & 7, to >> 3), board, path) && path == 0;
+	}
+
+	// Find the square pairs (white, black) of the critical pieces a table indexes: the smallest
+	// of each set of pairs the symmetries bring into each other, leaving out the pairs where
+	// both pieces attack each other with no square in between, which are never legal
+	std::vector<byte> pairsOf(const TbMaterial& m, const int* critIdx, int symmetries) const
+	{
+		std::vector<byte> pairs;
+		byte w = m.pieces[critIdx[1]], b = m.pieces[critIdx[0]];
+		for (int ws = 0; ws < 64; ws++)
+		{
+			for (int bs = 0; bs < 64; bs++)
+			{
+				if (ws == bs || (touches(w, ws, bs) && touches(b, bs, ws))) { continue; }
+				bool smallest = true;
+				for (int t = 1; t < 8 && smallest; t++)
+				{
+					smallest = !(symmetries >> t & 1) || (tbTransform(t, ws) << 6 | tbTransform(t, bs)) >= (ws << 6 | bs);
+				}
+				if (!smallest) { continue; }
+				pairs.push_back((byte)ws);
+				pairs.push_back((byte)bs);
+			}
+		}
+		return pairs;
+	}
+
+	// Check if the quiet moves of a piece undo themselves: alone on the board, it moves from
+	// a to b over the same squares as from b to a. The positions reaching a position by a
+	// move of such a piece are then found by its moves to empty squares.
+	bool undoesItself(byte piece) const
+	{
+		PieceDef* def = defs[piece & PIECE_ID];
+		if (def->irreversible) { return false; }
+		UINT64 reach[64];
+		for (int sqr = 0; sqr < 64; sqr++)
+		{
+			BoardState board = BoardState();
+			board.set(sqr, tbPieceByte(defs, piece, sqr));
+			MoveList moves;
+			def->generateMoves(IVec2(sqr & 7, sqr >> 3), board, moves);
+			reach[sqr] = 0;
+			for (int k = 0; k < moves.size; k++)
+			{
+				if (moves[k].flags() == MoveQuiet) { reach[sqr] |= SQUARE_BB(moves[k].to()); }
+			}
+		}
+		for (int a = 0; a < 64; a++)
+		{
+			UINT64 targets = reach[a];
+			while (targets)
+			{
+				int b = popLsb(targets);
+				if (!(reach[b] & SQUARE_BB(a))) { return false; }
+				BoardState boardA = BoardState(), boardB = BoardState();
+				boardA.set(a, tbPieceByte(defs, piece, a));
+				boardB.set(b, tbPieceByte(defs, piece, b));
+				UINT64 pathA, pathB;
+				if (!def->attackPath(IVec2(a & 7, a >> 3), IVec2(b & 7, b >> 3), boardA, pathA) ||
+					!def->attackPath(IVec2(b & 7, b >> 3), IVec2(a & 7, a >> 3), boardB, pathB) || pathA != pathB)
+				{
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+
+	// Check if a square is attacked by the pieces of a team
+	bool attacked(const BoardState& board, int sqr, int team) const
+	{
+		IVec2 end = IVec2(sqr & 7, sqr >> 3);
+		UINT64 pieces = board.teamBB[team];
+		while (pieces)
+		{
+			int i = popLsb(pieces);
+			UINT64 path;
+			if (defs[board[i] & PIECE_ID]->attackPath(IVec2(i & 7, i >> 3), end, board, path) && (path & board.occupied) == 0)
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	// Square of the critical piece of a team
+	int critSquare(const BoardState& board, int team) const
+	{
+		return bitScan(board.pieceBB[team][crits[team]]);
+	}
+
+	// Put the position of an index on the board of a scratch
+	void place(Scratch& s, UINT64 idx)
+	{
+		for (int i = 0; i < s.count; i++) { s.board.set(s.squares[i], 0); }
+		table->decode(idx, s.squares, s.team);
+		s.count = table->material.count;
+		for (int i = 0; i < s.count; i++)
+		{
+			if (s.board[s.squares[i]] != 0) { continue; } // Overlapping pieces, only checked by isValid
+			s.board.set(s.squares[i], tbPieceByte(defs, table->material.pieces[i], s.squares[i]));
+		}
+	}
+
+	// Check if an index is a legal position of the table in its canonical form
+	bool isValid(Scratch& s, UINT64 idx)
+	{
+		const TbMaterial& m = table->material;
+		place(s, idx);
+		for (int i = 0; i < m.count; i++)
+		{
+			for (int j = 0; j < i; j++)
+			{
+				if (s.squares[i] == s.squares[j]) { return false; }
+			}
+		}
+		// The team which just moved can't be in check
+		return table->index(s.squares, s.team) == idx && !attacked(s.board, critSquare(s.board, s.team ^ 1), s.team);
+	}
+
+	// Go through the moves of a position: mark it invalid, or count the distinct positions
+	// of the table it reaches and add it to the solved positions if it is a checkmate or the
+	// other tables solve it. Returns false if it reaches too many positions to count.
+	bool initPosition(Scratch& s, UINT64 idx, std::vector<Solved>& solved)
+	{
+		if (!isValid(s, idx))
+		{
+			values[idx] = TB_INVALID;
+			return true;
+		}
+		const TbMaterial& m = table->material;
+		BoardState& board = s.board;
+		int team = s.team, legal = 0, reachedCount = 0, minLoss = 1000, maxWin = -1;
+		bool open = false; // Another table has a draw or a win for the team to move
+		UINT64 reached[MAX_MOVES];
+		for (int i = 0; i < m.count; i++)
+		{
+			if (((m.pieces[i] & PIECE_TEAM) != 0) != (team == 1)) { continue; }
+			int from = s.squares[i];
+			byte p = board[from];
+			MoveList moves;
+			defs[p & PIECE_ID]->generateMoves(IVec2(from & 7, from >> 3), board, moves);
+			for (int k = 0; k < moves.size; k++)
+			{
+				const Move& move = moves[k];
+				if (move.flags() & MoveCastle) { continue; } // Not in the tables
+				int to = move.to();
+				byte captured = board[to];
+				// Make the move, and check it doesn't leave the critical piece attacked
+				board.set(to, tbPieceByte(defs, p, to));
+				board.set(from, 0);
+				bool ok = !attacked(board, critSquare(board, team), team ^ 1);
+				board.set(from, p);
+				board.set(to, captured);
+				if (!ok) { continue; }
+				legal++;
+				// Pieces after the move, in material order
+				byte pieces[TB_MAX_PIECES], squares[TB_MAX_PIECES];
+				int n = 0;
+				for (int j = 0; j < m.count; j++)
+				{
+					if (j != i && s.squares[j] == to) { continue; } // Captured
+					pieces[n] = m.pieces[j];
+					squares[n++] = (byte)(j == i ? to : s.squares[j]);
+				}
+				if (captured == 0 && !(move.flags() & MovePromotion))
+				{
+					if (reachedCount == MAX_MOVES) { return false; }
+					reached[reachedCount++] = table->index(squares, team ^ 1);
+					continue;
+				}
+				// Value of each position of the other tables the move reaches, one per piece to promote to
+				for (int id = (move.flags() & MovePromotion) ? 1 : 0; id < 16; id++)
+				{
+					byte v;
+					if (id != 0)
+					{
+						if (defs[id] == NULL || defs[id]->critical || id == (p & PIECE_ID)) { continue; }
+						byte promoted[TB_MAX_PIECES];
+						memcpy(promoted, pieces, n);
+						for (int j = 0; j < n; j++)
+						{
+							if (squares[j] == to) { promoted[j] = (byte)((p & PIECE_TEAM) | id); }
+						}
+						v = tables.probeValue(promoted, squares, n, team ^ 1);
+					}
+					else { v = tables.probeValue(pieces, squares, n, team ^ 1); }
+					int d = v - 1;
+					if (v == 0 || v == TB_INVALID) { open = true; }
+					else if (d & 1) { maxWin = std::max(maxWin, d); }
+					else
+					{
+						open = true;
+						minLoss = std::min(minLoss, d);
+					}
+					if (id == 0) { break; }
+				}
+			}
+		}
+		if (legal == 0)
+		{
+			if (attacked(board, critSquare(board, team), team ^ 1)) { solved.push_back(Solved(idx, 0)); }
+			return true; // Stalemates stay draws
+		}
+		std::sort(reached, reached + reachedCount);
+		int distinct = (int)(std::unique(reached, reached + reachedCount) - reached) + open;
+		if (distinct >= 255) { return false; }
+		counts[idx] = (byte)distinct;
+		extWins[idx] = (byte)(maxWin + 1);
+		if (minLoss < 1000) { solved.push_back(Solved(idx, minLoss + 1)); }
+		if (distinct == 0) { solved.push_back(Solved(idx, maxWin + 1)); } // Every move loses to another table
+		return true;
+	}
+
+	// Find the distinct valid positions of the table reaching a position by a move: the
+	// moves of the team which just moved, backward
+	void unmoves(Scratch& s, UINT64 idx, std::vector<UINT64>& out)
+	{
+		const TbMaterial& m = table->material;
+		place(s, idx);
+		BoardState& board = s.board;
+		int mover = s.team ^ 1;
+		size_t first = out.size();
+		byte squares[TB_MAX_PIECES];
+		memcpy(squares, s.squares, m.count);
+		auto add = [&](int i, int from)
+		{
+			squares[i] = (byte)from;
+			UINT64 q = table->index(squares, mover);
+			squares[i] = s.squares[i];
+			if (q != ~0ULL && values[q] != TB_INVALID) { out.push_back(q); }
+		};
+		for (int i = 0; i < m.count; i++)
+		{
+			if (((m.pieces[i] & PIECE_TEAM) != 0) != (mover == 1)) { continue; }
+			int to = s.squares[i];
+			byte p = board[to];
+			PieceDef* def = defs[p & PIECE_ID];
+			if (undoes[m.pieces[i]])
+			{
+				MoveList moves;
+				def->generateMoves(IVec2(to & 7, to >> 3), board, moves);
+				for (int k = 0; k < moves.size; k++)
+				{
+					if (moves[k].flags() == MoveQuiet) { add(i, moves[k].to()); }
+				}
+				continue;
+			}
+			// Put the piece on each empty square, and keep those it moves to its square from
+			UINT64 froms = table->domains[i] & ~board.occupied;
+			board.set(to, 0);
+			while (froms)
+			{
+				int from = popLsb(froms);
+				board.set(from, tbPieceByte(defs, m.pieces[i], from));
+				MoveList moves;
+				def->generateMoves(IVec2(from & 7, from >> 3), board, moves);
+				board.set(from, 0);
+				for (int k = 0; k < moves.size; k++)
+				{
+					if (moves[k].to() == to && moves[k].flags() == MoveQuiet)
+					{
+						add(i, from);
+						break;
+					}
+				}
+			}
+			board.set(to, p);
+		}
+		std::sort(out.begin() + first, out.end());
+		out.erase(std::unique(out.begin() + first, out.end()), out.end());
+	}
+
+	// Run body(scratch, i, thread) for i from 0 to n - 1 on the threads, in chunks
+	template<typename F>
+	void parallelFor(UINT64 n, UINT64 chunk, F body)
+	{
+		std::atomic<UINT64> next(0);
+		std::vector<std::thread> pool;
+		for (int t = 0; t < threads; t++)
+		{
+			pool.push_back(std::thread([&, t]()
+			{
+				Scratch s = Scratch();
+				for (UINT64 start = next.fetch_add(chunk); start < n; start = next.fetch_add(chunk))
+				{
+					UINT64 end = std::min(start + chunk, n);
+					for (UINT64 i = start; i < end; i++) { body(s, i, t); }
+				}
+			}));
+		}
+		for (auto& th : pool) { th.join(); }
+	}
+
+	// Solve the positions of the table, with the positions solved by the first pass put in
+	// the round of their distance. Returns the longest distance to mate.
+	int solveRounds(std::vector<std::vector<UINT64>>& rounds)
+	{
+		int maxDistance = 0;
+		for (int r = 0; r <= TB_MAX_DISTANCE; r++)
+		{
+			std::vector<UINT64> frontier;
+			for (UINT64 idx : rounds[r])
+			{
+				if (values[idx] != 0) { continue; } // Solved at a shorter distance
+				values[idx] = (byte)(r + 1);
+				frontier.push_back(idx);
+			}
+			rounds[r] = std::vector<UINT64>();
+			if (frontier.empty())
+			{
+				bool more = false;
+				for (int l = r + 1; l <= TB_MAX_DISTANCE && !more; l++) { more = !rounds[l].empty(); }
+				if (!more) { break; }
+				continue;
+			}
+			maxDistance = r;
+			std::vector<std::vector<UINT64>> found(threads);
+			parallelFor(frontier.size(), 1 << 8, [&](Scratch& s, UINT64 i, int t) { unmoves(s, frontier[i], found[t]); });
+			for (auto& list : found)
+			{
+				for (UINT64 q : list)
+				{
+					if (values[q] != 0) { continue; }
+					if (!(r & 1))
+					{
+						// Reaches a loss
+						if (r + 1 <= TB_MAX_DISTANCE) { rounds[r + 1].push_back(q); }
+					}
+					else if (counts[q] > 0 && --counts[q] == 0)
+					{
+						// Every move reaches a win
+						int l = std::max(r, extWins[q] - 1) + 1;
+						if (l <= TB_MAX_DISTANCE) { rounds[l].push_back(q); }
+					}
+				}
+			}
+		}
+		return maxDistance;
+	}
+
+public:
+	int threads;	// Threads generating a table
+
+	// Create generator of the pieces, writing the tables in the folder of the tables
+	TablebaseGen(PieceDef** defs, Tablebases& tables, int threads) : defs(defs), tables(tables), table(NULL),
+		crits{ }, undoes{ }, threads(threads > 0 ? threads : 1) {};
+
+	// Check if a material can have a table. Returns false with the reason if not.
+	bool supports(const TbMaterial& m, std::string& reason) const
+	{
+		int critCount[2] = { 0, 0 }, irreversibleCount[2] = { 0, 0 };
+		for (int i = 0; i < m.count; i++)
+		{
+			PieceDef* def = defs[m.pieces[i] & PIECE_ID];
+			if (def == NULL) { reason = "unknown piece"; return false; }
+			if (!def->hasAttackPaths()) { reason = "a piece has no attack paths"; return false; }
+			critCount[(m.pieces[i] & PIECE_TEAM) != 0] += def->critical;
+			irreversibleCount[(m.pieces[i] & PIECE_TEAM) != 0] += def->irreversible;
+		}
+		if (critCount[0] != 1 || critCount[1] != 1) { reason = "each team needs one critical piece"; return false; }
+		// The tables hold no en passant rights, so a double push must never be answered by one
+		if (irreversibleCount[0] != 0 && irreversibleCount[1] != 0)
+		{
+			reason = "both teams have pawns, en passant captures aren't in the tables";
+			return false;
+		}
+		return true;
+	}
+
+	// Materials the moves of a material reach: without each captured piece, with each
+	// irreversible piece promoted, and both when a promotion captures
+	std::vector<TbMaterial> children(const TbMaterial& m) const
+	{
+		std::vector<TbMaterial> out;
+		byte squares[TB_MAX_PIECES] = { };
+		auto add = [&](TbMaterial c)
+		{
+			TbMaterial::sort(c.pieces, squares, c.count);
+			for (auto& o : out)
+			{
+				if (o.count == c.count && memcmp(o.pieces, c.pieces, c.count) == 0) { return; }
+			}
+			out.push_back(c);
+		};
+		for (int i = 0; i < m.count; i++)
+		{
+			PieceDef* def = defs[m.pieces[i] & PIECE_ID];
+			if (!def->critical)
+			{
+				TbMaterial c = TbMaterial{ 0, { } };
+				for (int j = 0; j < m.count; j++)
+				{
+					if (j != i) { c.pieces[c.count++] = m.pieces[j]; }
+				}
+				add(c);
+			}
+			if (!def->irreversible) { continue; }
+			for (int id = 1; id < 16; id++)
+			{
+				if (defs[id] == NULL || defs[id]->critical || id == (m.pieces[i] & PIECE_ID)) { continue; }
+				byte promoted = (byte)((m.pieces[i] & PIECE_TEAM) | id);
+				TbMaterial c = m;
+				c.pieces[i] = promoted;
+				add(c);
+				// Promotions capturing an enemy piece
+				for (int j = 0; j < m.count; j++)
+				{
+					if (((m.pieces[j] ^ m.pieces[i]) & PIECE_TEAM) == 0 || defs[m.pieces[j] & PIECE_ID]->critical) { continue; }
+					c = TbMaterial{ 0, { } };
+					for (int k = 0; k < m.count; k++)
+					{
+						if (k != j) { c.pieces[c.count++] = k == i ? promoted : m.pieces[k]; }
+					}
+					add(c);
+				}
+			}
+		}
+		return out;
+	}
+
+	// Generate the table of a material and save it in the folder of the tables, after the
+	// tables of the materials its moves reach. Tables already in the folder are kept, but
+	// the tables they reach are still opened: the threads probe the tables of every material
+	// reachable from the one being generated, and only read the opened ones (opening a table
+	// isn't thread safe). report is called with each table generated and the seconds it
+	// took. Returns false with the reason if a table can't be generated or saved.
+	template<typename F>
+	bool generate(const TbMaterial& m, std::string& reason, F report)
+	{
+		if (opened.count(m.name()) != 0) { return true; }
+		if (!supports(m, reason)) { return false; }
+		std::vector<TbMaterial> subs = children(m);
+		for (auto& sub : subs)
+		{
+			if (!generate(sub, reason, report)) { return false; }
+		}
+		if (tables.find(m) != NULL)
+		{
+			opened.insert(m.name());
+			return true;
+		}
+
+		auto startTime = std::chrono::steady_clock::now();
+		int critIdx[2] = { 0, 0 };
+		UINT64 domains[TB_MAX_PIECES] = { };
+		for (int i = 0; i < m.count; i++)
+		{
+			int team = (m.pieces[i] & PIECE_TEAM) != 0;
+			if (defs[m.pieces[i] & PIECE_ID]->critical)
+			{
+				critIdx[team] = i;
+				crits[team] = m.pieces[i] & PIECE_ID;
+			}
+			for (int sqr = 0; sqr < 64; sqr++)
+			{
+				if (allowed(m.pieces[i], sqr)) { domains[i] |= SQUARE_BB(sqr); }
+			}
+			undoes[m.pieces[i]] = undoesItself(m.pieces[i]);
+		}
+		int symmetries = symmetriesOf(m);
+		std::unique_ptr<Tablebase> gen(new Tablebase(m, critIdx, domains, symmetries, pairsOf(m, critIdx, symmetries)));
+		table = gen.get();
+		values.assign((size_t)table->size(), 0);
+		counts.assign((size_t)table->size(), 0);
+		extWins.assign((size_t)table->size(), 0);
+		table->setValues(values.data());
+		// First pass, the positions solved go in the round of their distance
+		std::vector<std::vector<Solved>> solved(threads);
+		std::atomic<bool> overflow(false);
+		parallelFor(table->size(), 1 << 14, [&](Scratch& s, UINT64 idx, int t)
+		{
+			if (!initPosition(s, idx, solved[t])) { overflow = true; }
+		});
+		if (overflow)
+		{
+			table = NULL;
+			reason = "a position reaches too many positions";
+			return false;
+		}
+		std::vector<std::vector<UINT64>> rounds(TB_MAX_DISTANCE + 1);
+		for (auto& list : solved)
+		{
+			for (auto& f : list)
+			{
+				if (f.second <= TB_MAX_DISTANCE) { rounds[f.second].push_back(f.first); }
+			}
+		}
+		solved = std::vector<std::vector<Solved>>();
+		table->maxDistance = solveRounds(rounds);
+		counts = std::vector<byte>();
+		extWins = std::vector<byte>();
+		bool saved = table->save(tables.fileOf(m));
+		table = NULL;
+		values = std::vector<byte>();
+		if (!saved)
+		{
+			reason = "can't write " + tables.fileOf(m);
+			return false;
+		}
+		const Tablebase* t = tables.find(m);
+		if (t == NULL) { reason = "can't open " + tables.fileOf(m); return false; }
+		opened.insert(m.name());
+		report(*t, std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count());
+		return true;
+	}
+};
@@ -0,0 +1,209 @@
+// TbGen.cpp : Endgame tablebase generator. Solves every position of small materials (up to
+// TB_MAX_PIECES pieces, kings included) by retrograde analysis, and writes a table file per
+// material which the game maps and probes after each move (see Tablebase.h).
+//
+// Usage:
+//   tbgen <material>... [-path <folder>] [-threads <n>] [-verify <n>]
+//     Generate the tables of the materials, for both teams, and of the materials their
+//     captures and promotions reach. Materials are named by the piece letters of white,
+//     then "v" and those of black, ex. KQvK or KRPvKR. Tables already in the folder are kept.
+//     With -verify, up to n positions of each new table are checked against the move
+//     generator of the game.
+//   tbgen -probe "<fen>" [-path <folder>]
+//     Print the result of a position from the tables.
+// The tables are generated for the standard pieces. Other piece sets register their pieces
+// like the game does, with their letters (see Tablebases::setPath).
+//
+
+#define _CRT_SECURE_NO_WARNINGS
+#define NOMINMAX // std::min and std::max, not the macros of <Windows.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Position.h"
+#include "StandardPieces.h"
+#include "Fen.h"
+#include "Tablebase.h"
+#include "TablebaseGen.h"
+
+// Print the statistics of a generated table
+void report(const Tablebase& table, double seconds)
+{
+	UINT64 counts[2][3] = { }; // Losses, draws and wins of each team to move
+	UINT64 valid = 0;
+	for (UINT64 i = 0; i < table.size(); i++)
+	{
+		TbResult r;
+		if (!TbResult::fromValue(table.value(i), r)) { continue; }
+		counts[i >= table.size() / 2][r.wdl + 1]++;
+		valid++;
+	}
+	int symmetries = 0;
+	for (int t = 0; t < 8; t++) { symmetries += table.symmetries >> t & 1; }
+	printf("%-8s %11llu positions %11llu legal  %d symmetries  longest mate %3d plies  %7.2fs\n",
+		table.material.name().c_str(), table.size(), valid, symmetries, table.maxDistance, seconds);
+	for (int team = 1; team >= 0; team--)
+	{
+		printf("         %s to move: %llu wins, %llu draws, %llu losses\n", team ? "white" : "black",
+			counts[team][2], counts[team][1], counts[team][0]);
+	}
+}
+
+// Value of the position of a Position in the tables, ignoring the flags of its pieces
+byte probeAny(Position& pos)
+{
+	byte pieces[TB_MAX_PIECES], squares[TB_MAX_PIECES];
+	int n = 0;
+	UINT64 occ = pos.board.occupied;
+	while (occ && n < TB_MAX_PIECES)
+	{
+		int sqr = popLsb(occ);
+		pieces[n] = pos.board[sqr] & (PIECE_ID | PIECE_TEAM);
+		squares[n++] = (byte)sqr;
+	}
+	return tablebases().probeValue(pieces, squares, n, pos.currTeam);
+}
+
+// Check the values of a table against the moves of the positions, found by the move
+// generator of the game: the value of each position must follow from the values of the
+// positions its legal moves reach. Checks at most samples positions spread over the table.
+// Returns the amount of positions which don't match.
+UINT64 verify(Position& pos, const Tablebase& table, UINT64 samples)
+{
+	UINT64 step = table.size() / samples + 1, bad = 0, checked = 0;
+	for (UINT64 idx = 0; idx < table.size(); idx += step)
+	{
+		byte stored = table.value(idx);
+		if (stored == TB_INVALID) { continue; }
+		byte squares[TB_MAX_PIECES];
+		int team;
+		table.decode(idx, squares, team);
+		BoardState board = BoardState();
+		for (int i = 0; i < table.material.count; i++)
+		{
+			board.set(squares[i], tbPieceByte(pos.pieceDefs, table.material.pieces[i], squares[i]));
+		}
+		pos.setBoard(board, (byte)team);
+		// Best value of the moves, like the generator: the fastest win, else the slowest loss
+		MoveList moves;
+		pos.generateLegalMoves(pos.currTeam, moves);
+		int minLoss = 1000, maxWin = -1;
+		bool allWins = true;
+		auto child = [&]()
+		{
+			byte v = probeAny(pos);
+			if (v == 0 || v == TB_INVALID) { allWins = false; }
+			else if ((v - 1) & 1) { maxWin = std::max(maxWin, v - 1); }
+			else
+			{
+				allWins = false;
+				minLoss = std::min(minLoss, v - 1);
+			}
+		};
+		for (int i = 0; i < moves.size; i++)
+		{
+			const Move& m = moves[i];
+			if (!pos.makeMove(m.start(), m.end())) { child(); }
+			for (int id = 0; id < 16 && (m.flags() & MovePromotion); id++)
+			{	// One position per piece to promote to, the move is made again for each
+				if (!pos.canPromote(m.end(), id)) { continue; }
+				pos.promote(m.end(), (byte)id);
+				child();
+				pos.undoMove();
+				pos.makeMove(m.start(), m.end());
+			}
+			pos.undoMove();
+		}
+		byte expected = 0;
+		if (moves.size == 0) { expected = pos.inCheck(pos.currTeam) ? 1 : 0; }
+		else if (minLoss < 1000) { expected = (byte)(minLoss + 2); }
+		else if (allWins) { expected = (byte)(maxWin + 2); }
+		if (expected > TB_MAX_DISTANCE + 1) { expected = 0; } // Too long for the tables
+		bad += stored != expected;
+		checked++;
+	}
+	printf("         verified %llu positions: %s (%llu mismatches)\n", checked, bad == 0 ? "match" : "DON'T MATCH", bad);
+	return bad;
+}
+
+// Print the result of a FEN position
+int probe(Position& pos, const char* fen)
+{
+	BoardState board;
+	byte team;
+	if (!loadFen(fen, board, team))
+	{
+		printf("bad FEN: %s\n", fen);
+		return 2;
+	}
+	pos.setBoard(board, team);
+	TbResult r;
+	if (!tablebases().probe(pos, r))
+	{
+		printf("no table for this position\n");
+		return 1;
+	}
+	const char* mover = team ? "white" : "black";
+	if (r.wdl == 0) { printf("draw\n"); }
+	else if (r.wdl > 0) { printf("%s mates in %d (%d plies)\n", mover, (r.distance + 1) / 2, r.distance); }
+	else { printf("%s is mated in %d (%d plies)\n", mover, r.distance / 2, r.distance); }
+	return 0;
+}
+
+int usage()
+{
+	printf("usage: tbgen <material>... [-path <folder>] [-threads <n>] [-verify <n>]\n");
+	printf("       tbgen -probe \"<fen>\" [-path <folder>]\n");
+	return 2;
+}
+
+int main(int argc, char** argv)
+{
+	StandardPieces pieces;
+	Position pos = Position(pieces.list());
+	int threads = (int)std::thread::hardware_concurrency();
+	const char* path = TB_DEFAULT_PATH;
+	const char* fen = NULL;
+	UINT64 samples = 0;
+	std::vector<TbMaterial> materials;
+	for (int i = 1; i < argc; i++)
+	{
+		TbMaterial m;
+		if (!strcmp(argv[i], "-path") && i + 1 < argc) { path = argv[++i]; }
+		else if (!strcmp(argv[i], "-threads") && i + 1 < argc) { threads = atoi(argv[++i]); }
+		else if (!strcmp(argv[i], "-probe") && i + 1 < argc) { fen = argv[++i]; }
+		else if (!strcmp(argv[i], "-verify") && i + 1 < argc) { samples = strtoull(argv[++i], NULL, 10); }
+		else if (TbMaterial::parse(argv[i], m)) { materials.push_back(m); }
+		else
+		{
+			printf("bad material: %s\n", argv[i]);
+			return usage();
+		}
+	}
+	tablebases().setPath(path);
+	if (fen != NULL) { return probe(pos, fen); }
+	if (materials.empty()) { return usage(); }
+
+	TablebaseGen gen(pos.pieceDefs, tablebases(), threads);
+	printf("%d thread(s), tables in %s\n", gen.threads, path);
+	UINT64 bad = 0;
+	auto done = [&](const Tablebase& table, double seconds)
+	{
+		report(table, seconds);
+		if (samples > 0) { bad += verify(pos, table, samples); }
+	};
+	for (auto& m : materials)
+	{
+		std::string reason;
+		if (!gen.generate(m, reason, done) || !gen.generate(m.swapped(), reason, done))
+		{
+			printf("%s: %s\n", m.name().c_str(), reason.c_str());
+			return 1;
+		}
+	}
+	return bad != 0;
+}